@@ -1,11 +1,14 @@
 #!/usr/bin/env python3
 
+import os
 import subprocess
 import numpy as np
 import pandas as pd
 import matplotlib.pyplot as plt
 import scipy.stats as stats
 
+from bss_results import read_jsonl
+
 
 d2_distances = np.arange(1, 15, 3)  # AP <==> STA
 #d1_distances = np.arange(20, 300, 120)  # AP1 <==> AP2
@@ -14,6 +17,7 @@ simulation_file = "scratch/2BSS"
 num_runs = 5
 
 rngRun=100
+results_file = "run_results.jsonl"
 
 results = []
 data_columns = ['Distance', 'Threshold', 'EnableObssPd', 'Mean Throughput (Mbps)', '95% Confidence Interval']
@@ -28,21 +32,20 @@ for threshold in obss_pd_thresholds:
             # Run simulation
             cmd = [
                 './ns3', 'run',
-                f"{simulation_file} --d2={d2} --obssPdThreshold={threshold} --enableObssPd=True --rngRun={rngRun}"
+                f"{simulation_file} --d2={d2} --obssPdThreshold={threshold} --enableObssPd=True --rngRun={rngRun} --resultsFile={results_file} --resultsFormat=jsonl"
             ]
             print("Running simulation:", ' '.join(cmd))
+            if os.path.exists(results_file):
+                os.remove(results_file)
             process = subprocess.Popen(cmd, stdout=subprocess.PIPE, text=True)
             stdout, _ = process.communicate()
 
-            # Fetching data from sim
+            # Fetching data from sim: mean throughput over every station of every BSS
             try:
-                for line in stdout.split('\n'):
-                    if "Throughput per STA:" in line:
-                        throughput = float(line.split('\t')[1].split(' ')[0])
-                        throughputs.append(throughput)
-                        break
-            except ValueError as e:
-                print("Error parsing throughput: ", e)
+                flows = read_jsonl(results_file)[0]['flows']
+                throughputs.append(np.mean([flow['throughput'] for flow in flows]))
+            except (OSError, IndexError, ValueError) as e:
+                print("Error reading results: ", e)
 
         if throughputs:
             mean_throughput = np.mean(throughputs)
@@ -55,7 +58,10 @@ for threshold in obss_pd_thresholds:
             error_margin = None
 
         results.append([d2, threshold, True, mean_throughput, error_margin])
-        print(f"Distance: {d2}m, Threshold: {threshold} dBm, enableObssPd: True, Throughput: {mean_throughput:.2f} +/- {error_margin:.2f} Mbps")
+        if mean_throughput is None:
+            print(f"Distance: {d2}m, Threshold: {threshold} dBm, enableObssPd: True, no results")
+        else:
+            print(f"Distance: {d2}m, Threshold: {threshold} dBm, enableObssPd: True, Throughput: {mean_throughput:.2f} +/- {error_margin:.2f} Mbps")
 
 # Iterate once with enableObssPd = False
 for d2 in d2_distances:
@@ -65,21 +71,20 @@ for d2 in d2_distances:
         # Run simulation
         cmd = [
             './ns3', 'run',
-            f"{simulation_file} --d2={d2} --enableObssPd=False"
+            f"{simulation_file} --d2={d2} --enableObssPd=False --rngRun={rngRun} --resultsFile={results_file} --resultsFormat=jsonl"
         ]
         print("Running simulation:", ' '.join(cmd))
+        if os.path.exists(results_file):
+            os.remove(results_file)
         process = subprocess.Popen(cmd, stdout=subprocess.PIPE, text=True)
         stdout, _ = process.communicate()
 
-        # Fetching data from sim
+        # Fetching data from sim: mean throughput over every station of every BSS
         try:
-            for line in stdout.split('\n'):
-                if "Throughput per STA:" in line:
-                    throughput = float(line.split('\t')[1].split(' ')[0])
-                    throughputs.append(throughput)
-                    break
-        except ValueError as e:
-            print("Error parsing throughput: ", e)
+            flows = read_jsonl(results_file)[0]['flows']
+            throughputs.append(np.mean([flow['throughput'] for flow in flows]))
+        except (OSError, IndexError, ValueError) as e:
+            print("Error reading results: ", e)
 
     if throughputs:
         mean_throughput = np.mean(throughputs)
@@ -92,7 +97,10 @@ for d2 in d2_distances:
         error_margin = None
 
     results.append([d2, 'N/A', False, mean_throughput, error_margin])
-    print(f"Distance: {d2}m, enableObssPd: False, Throughput: {mean_throughput:.2f} +/- {error_margin:.2f} Mbps")
+    if mean_throughput is None:
+        print(f"Distance: {d2}m, enableObssPd: False, no results")
+    else:
+        print(f"Distance: {d2}m, enableObssPd: False, Throughput: {mean_throughput:.2f} +/- {error_margin:.2f} Mbps")
 
 # Create DataFrame and save as CSV
 results_df = pd.DataFrame(results, columns=data_columns)
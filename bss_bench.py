@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+
+"""Regression benchmark of the 2BSS reference scenarios against a stored baseline.
+
+Runs a fixed set of scenarios one after the other on this machine (no
+cache, no parallel jobs, so the numbers are not disturbed by each other),
+--repeat times each, and keeps per scenario the median of
+
+    wallTime         setup + Simulator::Run(), seconds
+    setupTime        building the scenario, seconds
+    eventsPerSecond  events executed per second of Simulator::Run()
+    peakRss          MiB
+
+as the program reports them in its results record. Against the baseline
+file a scenario regresses when its wall or setup time grows, its event rate
+drops, or its peak RSS grows by more than the tolerance; the exit status is
+then 1. A changed event count is reported too: the simulation itself
+behaves differently, so its times are not comparable any more.
+
+    ./bss_bench.py --update-baseline     # on a known good build
+    ./bss_bench.py                       # after an ns-3 upgrade or a scenario change
+
+The default scenario is the nSTA=1 point, OBSS_PD on at -64 dBm. Every
+scenario runs --duration simulated seconds with traffic from warmupTime on.
+"""
+
+import argparse
+import json
+import os
+import platform
+import shutil
+import statistics
+import sys
+import tempfile
+import time
+
+from sweep_runner import find_binary, run_program
+
+# name -> arguments on top of the program defaults
+SCENARIOS = {
+    'default': [],
+    'wall-1': ['--scenario=scenarios/2bss-wall-1.conf'],
+    'wall-2': ['--scenario=scenarios/2bss-wall-2.conf'],
+    'obss-on': ['--enableObssPd=true', '--obssPdThreshold=-72'],
+    'obss-off': ['--enableObssPd=false'],
+    'nsta-10': ['--nSTA=10'],
+    'nsta-50': ['--nSTA=50'],
+    'legacy-mix': ['--nSTA=5', '--nSTALegacy=5'],
+}
+
+# metric -> +1 if larger is worse, -1 if smaller is worse
+METRICS = {'wallTime': 1, 'setupTime': 1, 'eventsPerSecond': -1, 'peakRss': 1}
+
+
+def measure(binary, args, repeat, env, work_dir):
+    """Median of every metric over `repeat` runs."""
+    runs = []
+    for _ in range(repeat):
+        result = run_program(binary, args, env, os.path.join(work_dir, 'bench.jsonl'))
+        if 'error' in result:
+            return result
+        run_time = max(result['wallTime'] - result['setupTime'], 1e-9)
+        runs.append({'wallTime': result['wallTime'], 'setupTime': result['setupTime'],
+                     'eventsPerSecond': result['events'] / run_time, 'peakRss': result['peakRss'],
+                     'events': result['events'], 'processTime': result['processTime'],
+                     'totalThroughput': result['totalThroughput']})
+    return {k: statistics.median(r[k] for r in runs) for k in runs[0]}
+
+
+def compare(name, current, baseline, tolerance):
+    """Lines describing the regressions of one scenario."""
+    problems = []
+    for metric, worse in METRICS.items():
+        old, new = baseline.get(metric), current[metric]
+        if not old:
+            continue
+        change = (new - old) / old
+        if worse * change > tolerance[metric]:
+            problems.append(f"{name}: {metric} {old:.4g} -> {new:.4g} ({change:+.1%}, tolerance {tolerance[metric]:.0%})")
+    if baseline.get('events') is not None and baseline['events'] != current['events']:
+        problems.append(f"{name}: {baseline['events']} -> {current['events']} events, "
+                        f"the scenario changed (update the baseline if that was intended)")
+    return problems
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--program', default='2BSS', help="scratch program name")
+    parser.add_argument('--binary', help="path of the compiled program, found under build/scratch by default")
+    parser.add_argument('--ns3-dir', default='.', help="ns-3 top level directory")
+    parser.add_argument('--baseline', default='bench_baseline.json', help="stored reference numbers")
+    parser.add_argument('--update-baseline', action='store_true', help="store this run as the new baseline")
+    parser.add_argument('--scenario', action='append', choices=sorted(SCENARIOS),
+                        help="run only these scenarios (repeatable), all by default")
+    parser.add_argument('--repeat', type=int, default=3, help="runs per scenario, the median counts")
+    parser.add_argument('--duration', type=int, default=10, help="simulated seconds per run")
+    parser.add_argument('--time-tolerance', type=float, default=0.15,
+                        help="allowed relative growth of wall and setup time, drop of the event rate")
+    parser.add_argument('--rss-tolerance', type=float, default=0.10, help="allowed relative growth of peak RSS")
+    parser.add_argument('--output', default='bench_results.json', help="numbers of this run")
+    args = parser.parse_args()
+
+    binary = args.binary or find_binary(args.program, args.ns3_dir)
+    env = dict(os.environ)
+    env['LD_LIBRARY_PATH'] = os.path.join(os.path.abspath(args.ns3_dir), 'build', 'lib') + os.pathsep + \
+        env.get('LD_LIBRARY_PATH', '')
+    here = os.path.dirname(os.path.abspath(__file__))
+    common = [f"--duration={args.duration}", f"--simulationTime={args.duration}", '--rngRun=1']
+    tolerance = {'wallTime': args.time_tolerance, 'setupTime': args.time_tolerance,
+                 'eventsPerSecond': args.time_tolerance, 'peakRss': args.rss_tolerance}
+
+    baseline = None
+    if not args.update_baseline:
+        if not os.path.exists(args.baseline):
+            print(f"No baseline in {args.baseline}, record one with --update-baseline", file=sys.stderr)
+            return 2
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if baseline.get('duration') != args.duration:
+            print(f"The baseline ran {baseline.get('duration')} s per scenario, this run {args.duration} s",
+                  file=sys.stderr)
+            return 2
+
+    work_dir = tempfile.mkdtemp(prefix='bench-')
+    current = {'host': platform.node(), 'machine': platform.machine(), 'duration': args.duration,
+               'created': time.strftime('%Y-%m-%d %H:%M:%S'), 'scenarios': {}}
+    problems = []
+    try:
+        for name in args.scenario or SCENARIOS:
+            # scenario files are given relative to the repository
+            scenario_args = [a.replace('--scenario=', '--scenario=' + here + os.sep) for a in SCENARIOS[name]]
+            result = measure(binary, scenario_args + common, args.repeat, env, work_dir)
+            if 'error' in result:
+                problems.append(f"{name}: failed, {result['error']}")
+                print(problems[-1])
+                continue
+            current['scenarios'][name] = result
+            print(f"{name:12s} wall {result['wallTime']:8.3f} s  setup {result['setupTime']:7.3f} s  "
+                  f"{result['eventsPerSecond']:12.0f} events/s  peak RSS {result['peakRss']:8.1f} MiB", flush=True)
+            if baseline is not None:
+                if name not in baseline['scenarios']:
+                    print(f"{name}: not in the baseline")
+                    continue
+                problems += compare(name, result, baseline['scenarios'][name], tolerance)
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+
+    with open(args.baseline if args.update_baseline else args.output, 'w') as f:
+        json.dump(current, f, indent=2, sort_keys=True)
+    if args.update_baseline:
+        print(f"Baseline written to {args.baseline}")
+    for line in problems:
+        print("REGRESSION " + line)
+    return 1 if problems else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
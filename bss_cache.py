@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+
+"""Content-addressed cache of simulation results.
+
+A run is identified by the SHA-256 of the simulation binary, of the ns-3
+libraries it loads (build/lib/libns3*) and of its resolved parameters: the
+program itself (--printParameters) reports every value the run depends
+on, from its defaults, the scenario file and the command line. A rebuilt
+binary or module or an edited scenario file never returns stale results,
+and a value given explicitly, through a scenario file or left at its
+default is the same run. Runs that write other files than the results
+record (sampleFile, the event profile, sweeps, drops, variants) are not
+cached, a hit could not give those back.
+
+Each result is one JSON file, the record bss_results.read_jsonl() gives,
+stored under <directory>/<first two hex digits>/<key>.json and written
+atomically, so a sweep killed halfway leaves only complete entries behind.
+
+    ./bss_cache.py .results_cache        # entries and size
+"""
+
+import glob
+import hashlib
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import threading
+
+
+def file_digest(path):
+    h = hashlib.sha256()
+    with open(path, 'rb') as f:
+        for block in iter(lambda: f.read(1 << 20), b''):
+            h.update(block)
+    return h.hexdigest()
+
+
+class ResultsCache:
+    def __init__(self, directory, lib_dir):
+        """`lib_dir` is the build/lib directory of the ns-3 tree the binary links against."""
+        self.directory = directory
+        self.lib_dir = lib_dir
+        self.hits = 0
+        self.misses = 0
+        self._lock = threading.Lock()  # get() is called from the runner threads
+        self._digests = {}  # path -> (mtime, size, digest), hashed once per build
+
+    def _file_digest(self, path):
+        st = os.stat(path)
+        cached = self._digests.get(path)
+        if cached is None or cached[:2] != (st.st_mtime_ns, st.st_size):
+            cached = (st.st_mtime_ns, st.st_size, file_digest(path))
+            self._digests[path] = cached
+        return cached[2]
+
+    def _resolve(self, binary, args):
+        """The program's resolved parameters for `args`, or None when the run must not be cached."""
+        env = dict(os.environ)
+        env['LD_LIBRARY_PATH'] = self.lib_dir + os.pathsep + env.get('LD_LIBRARY_PATH', '')
+        process = subprocess.run([binary] + args + ['--printParameters'], stdout=subprocess.PIPE,
+                                 stderr=subprocess.DEVNULL, text=True, env=env)
+        if process.returncode != 0:
+            return None
+        params = dict(line.split('=', 1) for line in process.stdout.splitlines() if '=' in line)
+        if 'outputs' not in params or params.pop('outputs'):
+            return None
+        return params
+
+    def key(self, binary, args):
+        """Key of running `binary` with `args` (no output file options), None if it is not cacheable."""
+        params = self._resolve(binary, args)
+        if params is None:
+            return None
+        h = hashlib.sha256()
+        h.update(self._file_digest(binary).encode())
+        for lib in sorted(glob.glob(os.path.join(self.lib_dir, 'libns3*'))):
+            h.update(b'\0' + os.path.basename(lib).encode() + b'\0' + self._file_digest(lib).encode())
+        for name in sorted(params):
+            h.update(b'\0' + name.encode() + b'=' + params[name].encode())
+        return h.hexdigest()
+
+    def _path(self, key):
+        return os.path.join(self.directory, key[:2], key + '.json')
+
+    def get(self, key):
+        """The stored result, or None."""
+        try:
+            with open(self._path(key)) as f:
+                result = json.load(f)
+        except (OSError, ValueError):
+            with self._lock:
+                self.misses += 1
+            return None
+        with self._lock:
+            self.hits += 1
+        return result
+
+    def put(self, key, result):
+        path = self._path(key)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        fd, tmp = tempfile.mkstemp(dir=os.path.dirname(path), suffix='.tmp')
+        with os.fdopen(fd, 'w') as f:
+            json.dump(result, f)
+        os.replace(tmp, path)
+
+
+if __name__ == '__main__':
+    directory = sys.argv[1] if len(sys.argv) > 1 else '.results_cache'
+    entries = size = 0
+    for root, _, files in os.walk(directory):
+        for name in files:
+            if name.endswith('.json'):
+                entries += 1
+                size += os.path.getsize(os.path.join(root, name))
+    print(f"{directory}: {entries} results, {size / 1e6:.1f} MB")
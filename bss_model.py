@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+
+"""Analytical per-BSS throughput estimate for the 2BSS line scenarios.
+
+From the same inputs as scratch/2BSS.cc (powSta/powAp, Friis loss, CCA-ED,
+preamble detection, OBSS_PD level, MCS, packetSize, offeredLoad), for the
+uplink flows of the line layout:
+
+1. Who defers to whom: the RSSI of one BSS's stations at another's against
+   CCA-ED, the preamble detection threshold and, with OBSS_PD, the OBSS_PD
+   level (a reset transmitter is then limited to 21 dBm minus the level's
+   distance from -82 dBm, as ConstantObssPdAlgorithm does).
+2. A Bianchi saturated DCF model (CWmin 15, 6 backoff stages, single MPDUs
+   as aggregation is off) over every BSS a station defers to both ways.
+3. A SINR check at the AP against the HE MCS threshold for transmitters that
+   do not defer to each other; a failing link loses the fraction of time the
+   interferer is on air, as does a station that defers one way only.
+
+predict() takes the run parameters as strings (a sweep point over the
+program defaults) and returns within tens of microseconds the Mb/s per BSS
+(1 Mb = 1024 * 1024 bit as in the C++ report) and a margin: the smallest distance in dB of
+any RSSI or SINR from the threshold that decided it. A large margin means no
+small change of the inputs changes the outcome, which is what the sweep
+runner prunes on. Scenarios outside this model (other layouts or loss
+models, walls, legacy stations, RTS/CTS) give None.
+
+    ./bss_model.py d1=140 obssPdThreshold=-72
+"""
+
+import json
+import math
+import sys
+
+# SimulationParameters defaults of scratch/2BSS.cc
+DEFAULTS = {'d1': '140', 'd2': '2', 'powSta': '15', 'powAp': '20', 'ccaEdTrSta': '-62', 'ccaEdTrAp': '-62',
+            'minimumRssi': '-82', 'mcs': '11', 'enableObssPd': 'true', 'obssPdThreshold': '-64',
+            'packetSize': '1472', 'nSTA': '1', 'nSTALegacy': '0', 'nAP': '2', 'layout': 'line',
+            'staPlacement': 'fixed', 'staCounts': '', 'staCountsLegacy': '', 'offeredLoad': '300',
+            'rtsCts': 'false', 'lossModels': 'ns3::FriisPropagationLossModel', 'walls': '', 'midWall': '',
+            'reverseBss': 'false'}
+
+FREQUENCY = 5.18e9  # Hz, channel 36
+NOISE_DBM = -174 + 10 * math.log10(20e6) + 7  # thermal noise over 20 MHz plus the 7 dB RxNoiseFigure
+SLOT, SIFS, AIFS = 9, 16, 16 + 3 * 9  # us, AC_BE
+CW_MIN, STAGES = 15, 6
+HE_PREAMBLE, HE_SYMBOL = 44, 13.6  # us, HE SU with one HE-LTF and 0.8 us GI
+ACK = 28  # us, non-HT at 24 Mb/s
+# data bits per HE symbol, 20 MHz, one spatial stream, MCS 0..11
+HE_DBPS = [117, 234, 351, 468, 702, 936, 1053, 1170, 1404, 1560, 1755, 1950]
+# SINR (dB) around which a 1500 byte MPDU stops getting through, MCS 0..11 (approximate)
+HE_SINR = [1.5, 4.5, 7.5, 10.0, 13.5, 17.0, 18.5, 20.0, 24.5, 26.5, 30.0, 32.0]
+OBSS_PD_MIN, TX_POWER_REF = -82.0, 21.0  # dBm, ConstantObssPdAlgorithm
+MAC_OVERHEAD = 8 + 20 + 8 + 26 + 4  # UDP, IPv4, LLC/SNAP, QoS MAC header, FCS
+IP_UDP = 28  # counted in the reported throughput like FlowMonitor does
+
+
+def _true(value):
+    return str(value).lower() in ('1', 'true')
+
+
+def friis_loss(distance):
+    """Loss in dB of ns3::FriisPropagationLossModel (no system loss) at FREQUENCY."""
+    wavelength = 299792458.0 / FREQUENCY
+    return 20 * math.log10(4 * math.pi * max(distance, 1e-3) / wavelength)
+
+
+def dbm_sum(*levels):
+    return 10 * math.log10(sum(10 ** (level / 10) for level in levels))
+
+
+def bianchi(n):
+    """Transmission probability per slot and conditional collision probability of n saturated stations."""
+    w, m = CW_MIN + 1, STAGES
+
+    def tau(p):
+        if abs(1 - 2 * p) < 1e-9:
+            p += 1e-9
+        return 2 * (1 - 2 * p) / ((1 - 2 * p) * (w + 1) + p * w * (1 - (2 * p) ** m))
+
+    if n == 1:
+        return tau(0.0), 0.0
+    low, high = 0.0, 1.0
+    for _ in range(60):
+        p = (low + high) / 2
+        if p - (1 - (1 - tau(p)) ** (n - 1)) < 0:
+            low = p
+        else:
+            high = p
+    return tau(p), p
+
+
+def saturation_throughput(n, packet_size, mcs):
+    """Mb/s shared by n saturated stations in one contention domain, and the busy time per packet (us)."""
+    bits = 16 + 8 * (packet_size + MAC_OVERHEAD) + 6
+    ppdu = HE_PREAMBLE + math.ceil(bits / HE_DBPS[mcs]) * HE_SYMBOL
+    busy = ppdu + SIFS + ACK + AIFS  # a collision costs about the same, the AckTimeout replaces the ACK
+    t, _ = bianchi(n)
+    p_tr = 1 - (1 - t) ** n
+    p_s = n * t * (1 - t) ** (n - 1) / p_tr
+    slot_time = (1 - p_tr) * SLOT + p_tr * busy
+    mbps = p_s * p_tr * 8 * (packet_size + IP_UDP) / slot_time / 1.048576
+    return mbps, busy
+
+
+def predict(params):
+    """{'bss': [Mb/s, ...], 'total': Mb/s, 'margin': dB}, or None for a scenario outside the model."""
+    p = dict(DEFAULTS)
+    p.update({k: str(v) for k, v in params.items()})
+    if (p['layout'] != 'line' or p['staPlacement'] != 'fixed' or p['staCounts'] or p['staCountsLegacy']
+            or int(p['nSTALegacy']) > 0 or _true(p['rtsCts']) or p['walls'] or p['midWall']
+            or p['lossModels'] != 'ns3::FriisPropagationLossModel'):
+        return None
+    n_ap, n_sta = int(p['nAP']), int(p['nSTA'])
+    d1, d2 = float(p['d1']), float(p['d2'])
+    power, cca_ed, pd = float(p['powSta']), float(p['ccaEdTrSta']), float(p['minimumRssi'])
+    mcs, packet_size = int(p['mcs']), int(p['packetSize'])
+    obss_pd = float(p['obssPdThreshold']) if _true(p['enableObssPd']) else None
+    offered = None if p['offeredLoad'] == 'full' else float(p['offeredLoad'])
+    if n_sta == 0 or mcs >= len(HE_DBPS):
+        return None
+
+    # uplink: the stations of a BSS share one spot (first AP's behind it, the others past theirs)
+    slots = [n_ap - 1 - i if _true(p['reverseBss']) else i for i in range(n_ap)]
+    ap = [s * d1 for s in slots]
+    sta = [x - d2 if s == 0 else x + d2 for x, s in zip(ap, slots)]
+
+    margins = []
+    defers = [[False] * n_ap for _ in range(n_ap)]  # defers[b][o]: stations of b hold off for those of o
+    reuse_power = [[power] * n_ap for _ in range(n_ap)]  # power b transmits with while o is on air
+    for b in range(n_ap):
+        for o in range(n_ap):
+            if b == o:
+                continue
+            rssi = power - friis_loss(abs(sta[b] - sta[o]))
+            margins.append(abs(rssi - cca_ed))
+            if rssi >= cca_ed:
+                defers[b][o] = True
+                continue
+            margins.append(abs(rssi - pd))
+            if rssi < pd:
+                continue
+            if obss_pd is not None:
+                margins.append(abs(rssi - obss_pd))
+                if rssi < obss_pd:
+                    reuse_power[b][o] = min(power, TX_POWER_REF - (obss_pd - OBSS_PD_MIN))
+                    continue
+            defers[b][o] = True
+
+    _, busy_time = saturation_throughput(1, packet_size, mcs)
+    per_sta = []
+    for b in range(n_ap):
+        domain = n_sta * (1 + sum(1 for o in range(n_ap) if o != b and defers[b][o] and defers[o][b]))
+        total, _ = saturation_throughput(domain, packet_size, mcs)
+        per_sta.append(min(total / domain, offered) if offered is not None else total / domain)
+
+    # fraction of time each BSS's stations are on air, from the unimpaired estimate
+    airtime = [min(1.0, n_sta * per_sta[b] * 1.048576 * busy_time / (8 * (packet_size + IP_UDP)))
+               for b in range(n_ap)]
+    bss = []
+    for b in range(n_ap):
+        share = 1.0
+        for o in range(n_ap):
+            if o == b or (defers[b][o] and defers[o][b]):
+                continue
+            if defers[b][o]:
+                share *= 1 - airtime[o]
+                continue
+            signal = reuse_power[b][o] - friis_loss(abs(sta[b] - ap[b]))
+            interference = reuse_power[o][b] - friis_loss(abs(sta[o] - ap[b]))
+            sinr = signal - dbm_sum(NOISE_DBM, interference)
+            margins.append(abs(sinr - HE_SINR[mcs]))
+            if sinr < HE_SINR[mcs]:
+                share *= 1 - airtime[o]
+        snr = power - friis_loss(d2) - NOISE_DBM
+        margins.append(abs(snr - HE_SINR[mcs]))
+        bss.append(n_sta * per_sta[b] * share if snr >= HE_SINR[mcs] else 0.0)
+    return {'bss': bss, 'total': sum(bss), 'margin': min(margins) if margins else math.inf}
+
+
+if __name__ == '__main__':
+    print(json.dumps(predict(dict(arg.split('=', 1) for arg in sys.argv[1:]))))
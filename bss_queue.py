@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+
+"""Persistent job queue for long sweeps, in one SQLite file.
+
+Every (point, rngRun) of a sweep is a row that goes pending -> running ->
+done (or failed after --max-attempts). A worker claims the longest pending
+job in one write transaction and holds a lease on it that it renews while
+the simulation runs; a job whose lease ran out (worker killed, machine
+rebooted) is pending again for anyone. That counts as a failed attempt,
+so a job that kills its worker every time ends up failed too. Results are committed to the file
+as each job finishes, so a sweep survives restarts and several worker
+pools, in different processes or shells, can drain the same queue.
+
+    ./bss_queue.py submit --db sweep.db --param d1=100:380:20 \\
+        --param obssPdThreshold=-64,-72,-78 --param enableObssPd=1,0 --runs 5
+    ./bss_queue.py work --db sweep.db --jobs 32      # in as many shells as wanted
+    ./bss_queue.py status --db sweep.db
+    ./bss_queue.py export --db sweep.db --output sweep_runs.jsonl
+
+Submitting the same grid again adds only the jobs that are not queued yet.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import socket
+import sqlite3
+import sys
+import tempfile
+import threading
+import time
+
+from bss_cache import ResultsCache
+from sweep_runner import DEFAULT_DURATION, build_jobs, build_points, find_binary, parse_values, read_scenario, run_job
+
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS jobs (
+    id INTEGER PRIMARY KEY,
+    params TEXT NOT NULL,          -- JSON object of the point's --name=value
+    extra TEXT NOT NULL,           -- JSON list of further arguments
+    rng_run INTEGER NOT NULL,
+    cost REAL NOT NULL,            -- expected run time, longest first
+    state TEXT NOT NULL DEFAULT 'pending',  -- pending, running, done, failed
+    worker TEXT,
+    lease_until REAL,
+    attempts INTEGER NOT NULL DEFAULT 0,
+    result TEXT,                   -- JSON record of bss_results.read_jsonl(), or the error
+    finished REAL,
+    UNIQUE (params, extra, rng_run)
+);
+CREATE INDEX IF NOT EXISTS jobs_claim ON jobs (state, cost);
+"""
+
+
+class JobQueue:
+    """One connection to the queue file; use one per thread."""
+
+    def __init__(self, path):
+        self.db = sqlite3.connect(path, timeout=60, isolation_level=None)
+        self.db.execute('PRAGMA journal_mode=WAL')
+        self.db.executescript(SCHEMA)
+
+    def add(self, jobs, extra):
+        """Queue sweep_runner jobs; returns how many were new."""
+        before = self.db.total_changes
+        self.db.execute('BEGIN IMMEDIATE')
+        self.db.executemany(
+            'INSERT OR IGNORE INTO jobs (params, extra, rng_run, cost) VALUES (?, ?, ?, ?)',
+            [(json.dumps(j['params'], sort_keys=True), json.dumps(extra), j['rngRun'], j['cost']) for j in jobs])
+        self.db.execute('COMMIT')
+        return self.db.total_changes - before
+
+    def claim(self, worker, lease, max_attempts):
+        """Take the longest pending (or abandoned) job for `lease` seconds; None when nothing is left.
+
+        Every claim counts as an attempt, so an abandoned job that has had
+        max_attempts is marked failed instead of being handed out again.
+        """
+        now = time.time()
+        self.db.execute('BEGIN IMMEDIATE')
+        self.db.execute("UPDATE jobs SET state = 'failed', result = ?, finished = ?, lease_until = NULL "
+                        "WHERE state = 'running' AND lease_until < ? AND attempts >= ?",
+                        (json.dumps({'error': 'lease expired, the worker running the job died'}), now, now,
+                         int(max_attempts)))
+        row = self.db.execute(
+            "SELECT id, params, extra, rng_run, cost FROM jobs "
+            "WHERE state = 'pending' OR (state = 'running' AND lease_until < ?) "
+            "ORDER BY cost DESC, id LIMIT 1", (now,)).fetchone()
+        if row is not None:
+            self.db.execute("UPDATE jobs SET state = 'running', worker = ?, lease_until = ?, attempts = attempts + 1 "
+                            "WHERE id = ?", (worker, now + lease, row[0]))
+        self.db.execute('COMMIT')
+        if row is None:
+            return None
+        return {'id': row[0], 'point': row[0], 'params': json.loads(row[1]), 'extra': json.loads(row[2]),
+                'rngRun': row[3], 'cost': row[4]}
+
+    def renew(self, job_id, worker, lease):
+        """Extend the lease; False if the job was given to someone else meanwhile."""
+        cursor = self.db.execute("UPDATE jobs SET lease_until = ? WHERE id = ? AND worker = ? AND state = 'running'",
+                                 (time.time() + lease, job_id, worker))
+        return cursor.rowcount == 1
+
+    def finish(self, job_id, worker, result, max_attempts):
+        """Store the result; a failed run goes back to pending until it has had max_attempts."""
+        if 'error' not in result:
+            state = "'done'"
+        else:
+            state = f"CASE WHEN attempts >= {int(max_attempts)} THEN 'failed' ELSE 'pending' END"
+        self.db.execute(f"UPDATE jobs SET state = {state}, result = ?, finished = ?, lease_until = NULL "
+                        f"WHERE id = ? AND worker = ? AND state = 'running'",
+                        (json.dumps(result), time.time(), job_id, worker))
+
+    def counts(self):
+        now = time.time()
+        counts = dict(self.db.execute('SELECT state, COUNT(*) FROM jobs GROUP BY state').fetchall())
+        counts['expired'] = self.db.execute("SELECT COUNT(*) FROM jobs WHERE state = 'running' AND lease_until < ?",
+                                            (now,)).fetchone()[0]
+        return counts
+
+    def results(self):
+        """(params, rngRun, result) of every finished job, in queue order."""
+        for params, rng_run, result in self.db.execute(
+                "SELECT params, rng_run, result FROM jobs WHERE state = 'done' ORDER BY id"):
+            yield json.loads(params), rng_run, json.loads(result)
+
+
+def work(args):
+    """Run jobs from the queue in args.jobs threads until it is empty."""
+    binary = args.binary or find_binary(args.program, args.ns3_dir)
+    env = dict(os.environ)
+    env['LD_LIBRARY_PATH'] = os.path.join(os.path.abspath(args.ns3_dir), 'build', 'lib') + os.pathsep + \
+        env.get('LD_LIBRARY_PATH', '')
+    cache = None if args.no_cache else ResultsCache(os.path.join(args.ns3_dir, args.cache),
+                                                    os.path.join(args.ns3_dir, 'build', 'lib'))
+    work_dir = tempfile.mkdtemp(prefix='queue-')
+    host = f"{socket.gethostname()}:{os.getpid()}"
+    lock = threading.Lock()
+    done = [0]
+
+    def worker(number):
+        name = f"{host}:{number}"
+        jobs = JobQueue(args.db)
+        while True:
+            job = jobs.claim(name, args.lease, args.max_attempts)
+            if job is None:
+                return
+            # renew the lease from a second connection while the simulation runs
+            running = threading.Event()
+
+            def heartbeat():
+                beats = None
+                while not running.wait(args.lease / 3):
+                    # a busy database only costs this beat, the lease outlasts two of them
+                    try:
+                        beats = beats or JobQueue(args.db)
+                        if not beats.renew(job['id'], name, args.lease):
+                            return
+                    except sqlite3.OperationalError:
+                        continue
+
+            beat = threading.Thread(target=heartbeat, daemon=True)
+            beat.start()
+            try:
+                result = run_job(binary, job, job['extra'], env, work_dir, cache)
+            except Exception as e:
+                result = {'error': f"{type(e).__name__}: {e}"}
+            finally:
+                running.set()
+                beat.join()
+            jobs.finish(job['id'], name, result, args.max_attempts)
+            with lock:
+                done[0] += 1
+                status = result.get('error', f"{result.get('totalThroughput', float('nan')):.2f} Mbps")
+                print(f"[{done[0]}] {job['params']} rngRun={job['rngRun']}: {status}", flush=True)
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(args.jobs)]
+    try:
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+    print(f"Queue drained after {done[0]} jobs here: {JobQueue(args.db).counts()}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('command', choices=['submit', 'work', 'status', 'export'])
+    parser.add_argument('--db', default='sweep_queue.db', help="queue file")
+    parser.add_argument('--param', action='append', default=[], metavar='NAME=VALUES',
+                        help="submit: grid axis, VALUES is \"a,b,c\" or \"start:stop:step\"")
+    parser.add_argument('--runs', type=int, default=5, help="submit: replications per point")
+    parser.add_argument('--rng-run-base', type=int, default=101, help="submit: rngRun of the first replication")
+    parser.add_argument('--scenario', help="submit: scenario file every run starts from")
+    parser.add_argument('--program', default='2BSS', help="work: scratch program name")
+    parser.add_argument('--binary', help="work: path of the compiled program, found under build/scratch by default")
+    parser.add_argument('--ns3-dir', default='.', help="work: ns-3 top level directory")
+    parser.add_argument('--jobs', type=int, default=os.cpu_count(), help="work: parallel workers")
+    parser.add_argument('--lease', type=float, default=120, help="work: seconds a claim lasts without renewal")
+    parser.add_argument('--max-attempts', type=int, default=3, help="work: tries before a job counts as failed")
+    parser.add_argument('--cache', default='.results_cache', help="work: results cache directory")
+    parser.add_argument('--no-cache', action='store_true', help="work: run everything and leave the cache alone")
+    parser.add_argument('--output', default='sweep_runs.jsonl', help="export: one JSON record per finished job")
+    parser.add_argument('extra', nargs='*', help="submit: extra arguments passed to every run (after --)")
+    args = parser.parse_args()
+
+    if args.command == 'submit':
+        params = {}
+        for item in args.param:
+            name, _, spec = item.partition('=')
+            params[name] = parse_values(spec)
+        duration = DEFAULT_DURATION
+        extra = list(args.extra)
+        if args.scenario:
+            duration = float(read_scenario(args.scenario).get('duration', duration))
+            extra = [f"--scenario={os.path.abspath(args.scenario)}"] + extra
+        jobs = build_jobs(build_points(params), args.runs, args.rng_run_base, duration)
+        added = JobQueue(args.db).add(jobs, extra)
+        print(f"{added} of {len(jobs)} jobs added to {args.db}")
+    elif args.command == 'work':
+        work(args)
+    elif args.command == 'status':
+        print(json.dumps(JobQueue(args.db).counts()))
+    else:
+        count = 0
+        with open(args.output, 'w') as f:
+            for params, rng_run, result in JobQueue(args.db).results():
+                result['params'] = dict(result.get('params', {}), **params)
+                f.write(json.dumps(result) + '\n')
+                count += 1
+        print(f"{count} results written to {args.output}")
+
+
+if __name__ == '__main__':
+    sys.exit(main())
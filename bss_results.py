@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+
+"""Read the result files written by the scratch programs (--resultsFile).
+
+Every format comes back as the same list of runs, one dict per run with the
+layout of a JSON lines record:
+
+    {'run': 0, 'params': {'d1': '140', ...},
+     'flows': [{'flowId': 1, 'bss': 1, 'sta': 0, 'standard': 'ax', 'ac': 'BE', ...}, ...],
+     'bss': [{'bss': 1, 'throughput': ..., 'throughputAX': ..., ...}, ...],
+     'throughputAX': ..., 'throughputLegacy': ..., 'totalThroughput': ..., 'wallTime': ..., 'simTime': ...,
+     'events': ..., 'peakRss': ..., 'setupTime': ...}
+"""
+
+import csv
+import json
+import struct
+import sys
+
+FLOW_FIELDS = ['flowId', 'bss', 'sta', 'port', 'standard', 'ac', 'txBytes', 'rxBytes', 'txPackets', 'rxPackets',
+               'lostPackets', 'delaySum', 'jitterSum', 'timeFirstTxPacket', 'timeLastRxPacket', 'throughput']
+BSS_FIELDS = ['bss', 'txBytes', 'rxBytes', 'txPackets', 'rxPackets', 'lostPackets', 'delaySum', 'jitterSum',
+              'throughput', 'throughputAX', 'throughputLegacy']
+TOTAL_FIELDS = ['throughputAX', 'throughputLegacy', 'totalThroughput', 'wallTime', 'simTime', 'events', 'peakRss',
+                'setupTime']
+
+# see BinaryResultsSink in scratch/bss-results.h
+BIN_VERSION = 1
+FLOW_STRUCT = struct.Struct('<IIIHBBQQIIIddddd')
+AC_NAMES = ['BE', 'BK', 'VI', 'VO']
+STRING_FIELDS = ('standard', 'ac')
+BSS_STRUCT = struct.Struct('<QQQQQddddd')
+TOTAL_STRUCT = struct.Struct('<dddddQdd')
+
+
+def _number(value):
+    try:
+        return int(value)
+    except ValueError:
+        return float(value)
+
+
+def read_jsonl(path):
+    with open(path) as f:
+        return [json.loads(line) for line in f if line.strip()]
+
+
+def read_csv(path):
+    runs = {}
+    with open(path, newline='') as f:
+        reader = csv.DictReader(f)
+        param_names = reader.fieldnames[2:reader.fieldnames.index('bss')]
+        for row in reader:
+            run = runs.setdefault(int(row['run']), {
+                'run': int(row['run']), 'params': {n: row[n] for n in param_names}, 'flows': [], 'bss': []})
+            if row['record'] == 'flow':
+                run['flows'].append({k: (row[k] if k in STRING_FIELDS else _number(row[k]))
+                                     for k in FLOW_FIELDS})
+            elif row['record'] == 'bss':
+                run['bss'].append({k: _number(row[k]) for k in BSS_FIELDS})
+            else:
+                run['throughputAX'] = float(row['throughputAX'])
+                run['throughputLegacy'] = float(row['throughputLegacy'])
+                run['totalThroughput'] = float(row['throughput'])
+                run['wallTime'] = float(row['wallTime'])
+                run['simTime'] = float(row['simTime'])
+                run['events'] = int(row['events'])
+                run['peakRss'] = float(row['peakRss'] or 0)  # empty when the run's own peak is not known
+                run['setupTime'] = float(row['setupTime'])
+    return [runs[k] for k in sorted(runs)]
+
+
+def read_bin(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'BSSR':
+        raise ValueError(f"{path} is not a binary results file")
+    version, = struct.unpack_from('<I', data, 4)
+    if version != BIN_VERSION:
+        raise ValueError(f"{path}: unsupported version {version}")
+    offset = 8
+    runs = []
+
+    def string():
+        nonlocal offset
+        length, = struct.unpack_from('<H', data, offset)
+        value = data[offset + 2:offset + 2 + length].decode()
+        offset += 2 + length
+        return value
+
+    while offset < len(data):
+        n_params, = struct.unpack_from('<H', data, offset)
+        offset += 2
+        params = {}
+        for _ in range(n_params):
+            name = string()
+            params[name] = string()
+        n_flows, n_bss = struct.unpack_from('<II', data, offset)
+        offset += 8
+        run = {'run': len(runs), 'params': params, 'flows': [], 'bss': []}
+        for _ in range(n_flows):
+            values = list(FLOW_STRUCT.unpack_from(data, offset))
+            offset += FLOW_STRUCT.size
+            values[4] = 'ax' if values[4] else 'legacy'
+            values[5] = AC_NAMES[values[5]]
+            run['flows'].append(dict(zip(FLOW_FIELDS, values)))
+        for i in range(n_bss):
+            values = BSS_STRUCT.unpack_from(data, offset)
+            offset += BSS_STRUCT.size
+            run['bss'].append(dict(zip(BSS_FIELDS, (i + 1,) + values)))
+        run.update(zip(TOTAL_FIELDS, TOTAL_STRUCT.unpack_from(data, offset)))
+        offset += TOTAL_STRUCT.size
+        runs.append(run)
+    return runs
+
+
+def read_samples(path):
+    """Throughput time series written with --sampleFile, one dict per run:
+
+        {'params': {...}, 'columns': ['time', 'bss1', ..., 'bss1_sta0', ...], 'rows': [[0.1, 12.5, ...], ...]}
+    """
+    runs = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            if line.startswith('#'):
+                params = dict(item.split('=', 1) for item in line[1:].split())
+                runs.append({'params': params, 'columns': None, 'rows': []})
+            elif runs[-1]['columns'] is None:
+                runs[-1]['columns'] = line.split(',')
+            else:
+                runs[-1]['rows'].append([float(v) for v in line.split(',')])
+    return runs
+
+
+def load_results(path):
+    """Pick the reader from the file extension (.csv, .jsonl or .bin)."""
+    if path.endswith('.csv'):
+        return read_csv(path)
+    if path.endswith('.bin'):
+        return read_bin(path)
+    return read_jsonl(path)
+
+
+if __name__ == '__main__':
+    for run in load_results(sys.argv[1]):
+        print(json.dumps(run))
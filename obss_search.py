@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+
+"""Find the obssPdThreshold that maximizes total throughput, per d1/d2 point.
+
+Successive halving over the threshold axis instead of a full grid: every
+point starts with a coarse set of thresholds (--spacing dB apart) and
+--runs replications each. After every round the better half of the
+thresholds stays, the thresholds whose 95% CI still overlaps the best one
+stay as well, and new thresholds go in halfway between the best one and its
+neighbours. Once they are no more than --tolerance dB apart, the survivors
+get twice the replications of the round before instead, until no other
+threshold is within the best one's CI (or --max-runs is reached).
+
+All thresholds of a point run with the same rngRun numbers (common random
+numbers), so their differences are not drowned in seed-to-seed noise. Jobs
+of all points of a round share one worker pool (sweep_runner.run_jobs).
+
+    ./obss_search.py --param d1=100:380:40 --param d2=2 --tolerance 1
+"""
+
+import argparse
+import csv
+import itertools
+import math
+import os
+import time
+
+import numpy as np
+import scipy.stats as stats
+
+from bss_cache import ResultsCache
+from sweep_runner import (DEFAULT_DURATION, build_jobs, build_points, find_binary, format_value, parse_values,
+                          read_scenario, run_jobs)
+
+
+def mean_ci(values):
+    """Mean and t-distribution 95% CI half-width (None below two values)."""
+    n = len(values)
+    mean = float(np.mean(values)) if n else None
+    margin = float(stats.t.ppf(0.975, n - 1) * np.std(values, ddof=1) / np.sqrt(n)) if n > 1 else None
+    return mean, margin
+
+
+class ThresholdSearch:
+    """Successive halving of the thresholds of one point."""
+
+    def __init__(self, low, high, spacing, tolerance, runs):
+        self.low, self.high, self.tolerance = low, high, tolerance
+        self.spacing = spacing
+        count = int(round((high - low) / spacing))
+        self.values = {round(low + i * (high - low) / max(count, 1), 3): [] for i in range(count + 1)}
+        self.alive = set(self.values)
+        self.target = {t: runs for t in self.values}  # replications each threshold should have
+        self.tried = {t: 0 for t in self.values}  # replications started, failed ones included
+        self.done = False
+
+    def pending(self):
+        """(threshold, first replication, replications) still to run this round."""
+        return [(t, self.tried[t], self.target[t] - self.tried[t]) for t in sorted(self.alive)
+                if self.target[t] > self.tried[t]]
+
+    def add(self, threshold, value):
+        """Result of the next replication of `threshold`, None if the run failed."""
+        self.tried[threshold] += 1
+        if value is not None:
+            self.values[threshold].append(value)
+
+    def best(self):
+        return max(self.alive, key=lambda t: mean_ci(self.values[t])[0])
+
+    def step(self, max_runs):
+        """Drop the worse thresholds, refine around the best one; returns False when done."""
+        # a threshold none of whose runs went through is out
+        self.alive = {t for t in self.alive if self.values[t]}
+        if not self.alive:
+            self.done = True
+            return False
+        means = {t: mean_ci(self.values[t]) for t in self.alive}
+        best = self.best()
+        best_mean, best_ci = means[best]
+        ranked = sorted(self.alive, key=lambda t: -means[t][0])
+        keep = set(ranked[:max(2, math.ceil(len(ranked) / 2))])
+        for t in ranked:
+            mean, ci = means[t]
+            # still statistically tied with the best one
+            if best_ci is not None and ci is not None and mean + ci >= best_mean - best_ci:
+                keep.add(t)
+        self.alive = keep
+
+        neighbours = sorted(self.values)
+        i = neighbours.index(best)
+        gaps = [abs(best - n) for n in neighbours[max(0, i - 1):i + 2] if n != best]
+        resolved = all(g <= self.tolerance + 1e-9 for g in gaps)
+        separated = len(self.alive) == 1 or all(
+            means[t][0] + (means[t][1] or 0) < best_mean - (best_ci or 0) for t in self.alive if t != best)
+        exhausted = all(self.tried[t] >= max_runs for t in self.alive)
+        if resolved and (separated or exhausted):
+            self.done = True
+            return False
+
+        runs = max(self.target[t] for t in self.alive)
+        if resolved:
+            runs = min(max_runs, 2 * runs)
+        else:
+            self.spacing = max(self.tolerance, self.spacing / 2)
+            for t in (best - self.spacing, best + self.spacing):
+                t = round(t, 3)
+                if self.low <= t <= self.high and t not in self.values:
+                    self.values[t] = []
+                    self.tried[t] = 0
+                    self.alive.add(t)
+        # newcomers catch up with the others so every comparison uses the same seeds
+        for t in self.alive:
+            self.target[t] = runs
+        return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--program', default='2BSS', help="scratch program name")
+    parser.add_argument('--binary', help="path of the compiled program, found under build/scratch by default")
+    parser.add_argument('--ns3-dir', default='.', help="ns-3 top level directory")
+    parser.add_argument('--scenario', help="scenario file every run starts from")
+    parser.add_argument('--param', action='append', default=[], metavar='NAME=VALUES',
+                        help="point axis (d1, d2, ...), VALUES is \"a,b,c\" or \"start:stop:step\"")
+    parser.add_argument('--low', type=float, default=-82, help="lowest threshold (dBm)")
+    parser.add_argument('--high', type=float, default=-62, help="highest threshold (dBm)")
+    parser.add_argument('--spacing', type=float, default=5, help="threshold spacing of the first round (dB)")
+    parser.add_argument('--tolerance', type=float, default=1, help="threshold resolution to stop at (dB)")
+    parser.add_argument('--runs', type=int, default=2, help="replications per threshold in the first round")
+    parser.add_argument('--max-runs', type=int, default=16, help="replication cap per threshold")
+    parser.add_argument('--rng-run-base', type=int, default=101, help="rngRun of the first replication")
+    parser.add_argument('--jobs', type=int, default=os.cpu_count(), help="parallel workers")
+    parser.add_argument('--cache', default='.results_cache', help="results cache directory")
+    parser.add_argument('--no-cache', action='store_true', help="run everything and leave the cache alone")
+    parser.add_argument('--output', default='obss_search.csv', help="best threshold per point")
+    parser.add_argument('--trace', default='obss_search_runs.csv', help="one row per simulation")
+    parser.add_argument('extra', nargs='*', help="extra arguments passed to every run (after --)")
+    args = parser.parse_args()
+
+    params = {}
+    for item in args.param:
+        name, _, spec = item.partition('=')
+        params[name] = parse_values(spec)
+    params.pop('obssPdThreshold', None)
+    params['enableObssPd'] = ['1']
+
+    binary = args.binary or find_binary(args.program, args.ns3_dir)
+    duration = DEFAULT_DURATION
+    if args.scenario:
+        duration = float(read_scenario(args.scenario).get('duration', duration))
+        args.extra = [f"--scenario={os.path.abspath(args.scenario)}"] + args.extra
+    points = build_points(params)
+    searches = [ThresholdSearch(args.low, args.high, args.spacing, args.tolerance, args.runs) for _ in points]
+
+    cache = None if args.no_cache else ResultsCache(os.path.join(args.ns3_dir, args.cache),
+                                                    os.path.join(args.ns3_dir, 'build', 'lib'))
+    start = time.time()
+    simulations = 0
+    trace = []
+    for round_number in itertools.count():
+        # one job list for the whole round: (point, threshold) pairs are the sweep points
+        cells, runs, first = [], [], []
+        for index, search in enumerate(searches):
+            for threshold, done, count in search.pending():
+                cells.append((index, threshold))
+                runs.append(count)
+                first.append(done)
+        if not cells:
+            break
+        cell_points = [dict(points[i], obssPdThreshold=format_value(t)) for i, t in cells]
+        jobs = build_jobs(cell_points, runs, args.rng_run_base, duration, first=first)
+        print(f"Round {round_number}: {len(jobs)} runs over {len(cells)} thresholds "
+              f"of {sum(not s.done for s in searches)} points")
+        run_jobs(binary, jobs, args.jobs, args.extra, args.ns3_dir, cache=cache)
+        simulations += len(jobs)
+        for job in sorted(jobs, key=lambda j: (j['point'], j['rngRun'])):
+            index, threshold = cells[job['point']]
+            value = job['result'].get('totalThroughput')
+            trace.append((index, threshold, job['rngRun'], value, job['result'].get('error', '')))
+            searches[index].add(threshold, value)
+        for search in searches:
+            if not search.done:
+                search.step(args.max_runs)
+
+    grid = sum(int(round((args.high - args.low) / args.tolerance)) + 1 for _ in points) * args.max_runs
+    print(f"Search finished in {time.time() - start:.1f} s, {simulations} simulations "
+          f"(a {args.tolerance} dB grid at {args.max_runs} runs would take {grid})")
+
+    names = sorted({k for p in points for k in p})
+    with open(args.output, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(names + ['bestThreshold', 'mean', 'ci95', 'runs', 'thresholdsTried'])
+        for point, search in zip(points, searches):
+            if not search.alive:
+                writer.writerow([point.get(n, '') for n in names] + ['', '', '', 0, len(search.values)])
+                continue
+            best = search.best()
+            mean, ci = mean_ci(search.values[best])
+            writer.writerow([point.get(n, '') for n in names] +
+                            [best, mean, '' if ci is None else ci, len(search.values[best]), len(search.values)])
+    with open(args.trace, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(names + ['obssPdThreshold', 'rngRun', 'totalThroughput', 'error'])
+        for index, threshold, rng_run, value, error in trace:
+            writer.writerow([points[index].get(n, '') for n in names] +
+                            [threshold, rng_run, '' if value is None else value, error])
+
+
+if __name__ == '__main__':
+    main()
@@ -26,107 +26,44 @@
 #include "ns3/csma-module.h"
 #include "ns3/flow-monitor-module.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/ipv4-address-generator.h"
 #include <math.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <sys/resource.h>
 #include "ns3/log.h"
 #include "ns3/rng-seed-manager.h"
 
+#include "bss-arp.h"
+#include "bss-channel.h"
+#include "bss-convergence.h"
+#include "bss-flows.h"
+#include "bss-flowstats.h"
+#include "bss-fork.h"
+#include "bss-profiler.h"
+#include "bss-results.h"
+#include "bss-sampler.h"
+#include "bss-scenario.h"
+#include "bss-traffic.h"
+#include "bss-topology.h"
+
 
 using namespace ns3;
 using namespace std;
 
 NS_LOG_COMPONENT_DEFINE("WifiBSSSimulation");
 
-
-
-
-/* populate ARP tables */
-void PopulateARPcache()
+/* all values that can be set from the command line for a single run */
+struct SimulationParameters
 {
-    NS_LOG_INFO("Populating ARP Cache");
-    Ptr<ArpCache> arp = CreateObject<ArpCache>();
-    arp->SetAliveTimeout(Seconds(3600 * 24 * 365));
-
-    for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); ++i)
-    {
-        Ptr<Ipv4L3Protocol> ip = (*i)->GetObject<Ipv4L3Protocol>();
-        NS_ASSERT(ip != nullptr); //0 -> nullptr
-        ObjectVectorValue interfaces;
-        ip->GetAttribute("InterfaceList", interfaces);
-
-        for (ObjectVectorValue::Iterator j = interfaces.Begin(); j != interfaces.End(); j++)
-        {
-            Ptr<Ipv4Interface> ipIface = (*j).second->GetObject<Ipv4Interface>();
-            NS_ASSERT(ipIface != nullptr);
-            Ptr<NetDevice> device = ipIface->GetDevice();
-            NS_ASSERT(device != nullptr);
-            Mac48Address addr = Mac48Address::ConvertFrom(device->GetAddress());
-
-            for (uint32_t k = 0; k < ipIface->GetNAddresses(); k++)
-            {
-                Ipv4Address ipAddr = ipIface->GetAddress(k).GetLocal();
-                if (ipAddr == Ipv4Address::GetLoopback())
-                    continue;
-
-                ArpCache::Entry *entry = arp->Add(ipAddr);
-                Ipv4Header ipv4Hdr;
-                ipv4Hdr.SetDestination(ipAddr);
-                Ptr<Packet> p = Create<Packet>(100);
-                entry->MarkWaitReply(ArpCache::Ipv4PayloadHeaderPair(p, ipv4Hdr));
-                entry->MarkAlive(addr);
-            }
-        }
-    }
-
-    for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); ++i)
-    {
-        Ptr<Ipv4L3Protocol> ip = (*i)->GetObject<Ipv4L3Protocol>();
-        NS_ASSERT(ip != nullptr);
-        ObjectVectorValue interfaces;
-        ip->GetAttribute("InterfaceList", interfaces);
-
-        for (ObjectVectorValue::Iterator j = interfaces.Begin(); j != interfaces.End(); j++)
-        {
-            Ptr<Ipv4Interface> ipIface = (*j).second->GetObject<Ipv4Interface>();
-            ipIface->SetAttribute("ArpCache", PointerValue(arp));
-        }
-    }
-}
-
-void installTrafficGenerator(Ptr<ns3::Node> fromNode, Ptr<ns3::Node> toNode, int port, std::string offeredLoad, int packetSize, int simulationTime, int warmupTime, uint8_t tosValue)
-{
-    NS_LOG_INFO("Installing traffic generator from node " << fromNode->GetId() << " to node " << toNode->GetId());
-
-    Ptr<Ipv4> ipv4 = toNode->GetObject<Ipv4>();           // Get Ipv4 instance of the node
-    Ipv4Address addr = ipv4->GetAddress(1, 0).GetLocal(); // Get Ipv4InterfaceAddress of xth interface.
-
-    ApplicationContainer sourceApplications, sinkApplications;
-
-    double min = 0.0;
-    double max = 1.0;
-    Ptr<UniformRandomVariable> fuzz = CreateObject<UniformRandomVariable>();
-    fuzz->SetAttribute("Min", DoubleValue(min));
-    fuzz->SetAttribute("Max", DoubleValue(max));
-
-    InetSocketAddress sinkSocket(addr, port);
-    sinkSocket.SetTos(tosValue);
-    OnOffHelper onOffHelper("ns3::UdpSocketFactory", sinkSocket);
-    onOffHelper.SetConstantRate(DataRate(offeredLoad + "Mbps"), packetSize);
-    sourceApplications.Add(onOffHelper.Install(fromNode)); //fromNode
-    PacketSinkHelper packetSinkHelper("ns3::UdpSocketFactory", sinkSocket);
-    sinkApplications.Add(packetSinkHelper.Install(toNode)); //toNode
-
-    sinkApplications.Start(Seconds(warmupTime));
-    sinkApplications.Stop(Seconds(simulationTime));
-    sourceApplications.Start(Seconds(warmupTime + fuzz->GetValue()));
-    sourceApplications.Stop(Seconds(simulationTime));
-}
-
-int main(int argc, char *argv[])
-{
-    NS_LOG_UNCOND("Starting the WiFi BSS Simulation");
+    std::string scenario; // file the option defaults were read from, if any
     double duration = 60.0;   // seconds default 5 //prev 20
-    double d1 = 140;        // AP <==> STA
-    double d2 = 2; // AP1 <==> AP2
+    double d1 = 140;        // AP1 <==> AP2
+    double d2 = 2; // AP <==> STA
     double powSta = 15.0;    // dBm
     double powAp = 20.0;     // dBm
     double ccaEdTrSta = -62; // dBm Signal Detection is then -82dBm
@@ -140,7 +77,16 @@ int main(int argc, char *argv[])
     int nSTA =  1;
     int nSTALegacy = 0;
     int nAP = 2;
+    std::string layout = "line"; // AP layout: line, grid, hex or random
+    std::string staPlacement = "fixed"; // stations at d2 from the AP, or "disc" of radius d2
+    std::string staCounts; // AX stations per BSS "a,b,c", nSTA for every BSS if empty
+    std::string staCountsLegacy; // legacy stations per BSS, nSTALegacy for every BSS if empty
+    bool reverseBss = false; // BSS i in the place of BSS nAP-1-i (AP2 and its stations placed first)
+    std::string lossModels = "ns3::FriisPropagationLossModel"; // "+"-separated chain of loss model TypeIds
+    std::string walls; // concrete walls "xMin:xMax:yMin:yMax:zMin:zMax;..."
+    std::string midWall; // "thickness:length:height" of a wall halfway between neighbouring APs
     std::string offeredLoad = "300"; //Mbps per station
+    uint32_t queueDepth = 0; // with offeredLoad=full: packets kept in the MAC queue, 0 fills it
     int simulationTime = 60.0; //default 20 //prev 60
     int warmupTime = 5;
     bool BE = true;
@@ -148,89 +94,244 @@ int main(int argc, char *argv[])
     bool rtsCts = false;
     double minimumRssi = -82; // dBm
     uint32_t rngRun = 1;
+    std::string phy = "yans"; // PHY and channel models: yans or spectrum (both: one single run on each, compared)
+    bool linkCache = true; // answer the channel's loss/delay queries from a per-pair table
+    bool cull = false; // frames skip the receivers they reach below cullFloor - cullMargin
+    double cullFloor = -92; // dBm, RxSensitivity
+    double cullMargin = 6; // dB, headroom for aggregate interference
+    std::string sampleFile; // per-interval BSS/station throughput, appended per run
+    double sampleInterval = 0.1; // seconds
+    double stopRelError = 0; // stop once every BSS's 95 % CI half-width is below this fraction of its mean, 0: never
+    double stopBatch = 1.0; // seconds, batch length of the stopping rule
+    uint32_t stopMinBatches = 10; // batches before the stopping rule may fire
+    bool checkpoint = false; // in sweeps, fork the obssPdThreshold variants of a point after its warmup
+    uint32_t forkJobs = 1; // variant children running at the same time
+    bool flowMonitor = false; // collect the results with FlowMonitor on every node instead of from the applications
+    bool l2Traffic = false; // packet sockets straight on the Wi-Fi devices: no IP stack, addresses or ARP
+    bool profile = false; // count and time the executed events per source
+    std::string profileFile = "event_profile.jsonl"; // one JSON line per profiled run
+    bool verbose = true; // print setup and per-port info while building the run
+};
+
+RunParameters DescribeParameters(const SimulationParameters &params);
+
+/* RNG stream of the random AP and station positions, outside the range ns-3 assigns streams from */
+const int64_t PLACEMENT_STREAM = 0;
+
+
+/*
+ * offeredLoad in Mb/s, or "full" for a full-buffer source keeping queueDepth packets (0: all) in the MAC queue.
+ * Every packet carries a SeqTsSizeHeader (inside packetSize) so the sink can time it.
+ * With l2 the same applications run over packet sockets from the first device of fromNode to the first
+ * device of toNode, `port` serving as the protocol number, and the TOS is not used (TID 0).
+ * `flow` (BSS, station, standard) is completed with the sink address, port and AC and registered in `flows`.
+ */
+TrafficFlow installTrafficGenerator(Ptr<ns3::Node> fromNode, Ptr<ns3::Node> toNode, int port, std::string offeredLoad, int packetSize, int simulationTime, int warmupTime, uint8_t tosValue, uint32_t queueDepth, bool l2, FlowRegistry &flows, FlowDescriptor flow)
+{
+    NS_LOG_INFO("Installing traffic generator from node " << fromNode->GetId() << " to node " << toNode->GetId());
 
+    std::string protocol = "ns3::UdpSocketFactory";
+    Address remote;
+    Address local;
+    Ipv4Address addr;
+    if (l2)
+    {
+        Ptr<NetDevice> fromDevice = fromNode->GetDevice(0);
+        Ptr<NetDevice> toDevice = toNode->GetDevice(0);
+        PacketSocketAddress toSocket;
+        toSocket.SetSingleDevice(fromDevice->GetIfIndex());
+        toSocket.SetPhysicalAddress(toDevice->GetAddress());
+        toSocket.SetProtocol(port);
+        PacketSocketAddress sinkSocket;
+        sinkSocket.SetSingleDevice(toDevice->GetIfIndex());
+        sinkSocket.SetProtocol(port);
+        protocol = "ns3::PacketSocketFactory";
+        remote = toSocket;
+        local = sinkSocket;
+        addr = Ipv4Address(toNode->GetId()); // no IP here: the sink node id stands in for its address
+        tosValue = 0;
+    }
+    else
+    {
+        Ptr<Ipv4> ipv4 = toNode->GetObject<Ipv4>();           // Get Ipv4 instance of the node
+        addr = ipv4->GetAddress(1, 0).GetLocal(); // Get Ipv4InterfaceAddress of xth interface.
+        InetSocketAddress sinkSocket(addr, port);
+        sinkSocket.SetTos(tosValue);
+        remote = sinkSocket;
+        local = sinkSocket;
+    }
 
-    CommandLine cmd(__FILE__);
-
-    cmd.AddValue("duration", "Duration of simulation (s)", duration);
-    cmd.AddValue("interval", "Inter packet interval (s)", interval);
-    cmd.AddValue("enableObssPd", "Enable/disable OBSS_PD", enableObssPd);
-    cmd.AddValue("obssPdThreshold", "obssPdThreshold", obssPdThreshold);
-    cmd.AddValue("d1", "Distance between AP1 and AP2 (m)", d1); //most likely D1
-    cmd.AddValue("d2", "Distance between AP and STA (m)", d2);
-    cmd.AddValue("mcs", "The constant MCS value to transmit HE PPDUs", mcs);
-    cmd.AddValue("mcsLegacy", "The constant MCS value to transmit HE PPDUs", mcsLegacy);
-    cmd.AddValue("offeredLoad", "offered load per station", offeredLoad);
-    cmd.AddValue("BE", "transmission of BK traffic", BE);
-    cmd.AddValue("r", "radius",r);
-    cmd.AddValue("nSTA", "number of stations", nSTA);
-    cmd.AddValue("nSTALegacy", "number of stations Legacy", nSTALegacy);
-    cmd.AddValue("rtsCts", "enable/disable RTS CTS", rtsCts);
-    cmd.AddValue("rngRun", "Run number to set for RNG", rngRun);
-    cmd.Parse(argc, argv);
-
-    RngSeedManager::SetRun(rngRun);
-
-    NS_LOG_INFO("Creating node containers");
-    NodeContainer wifiApNodes;
-    wifiApNodes.Create(nAP);
+    ApplicationContainer sourceApplications, sinkApplications;
 
-    NodeContainer wifiStaNodes[nAP];
-    NodeContainer wifiStaNodesLegacy[nAP];
+    double min = 0.0;
+    double max = 1.0;
+    Ptr<UniformRandomVariable> fuzz = CreateObject<UniformRandomVariable>();
+    fuzz->SetAttribute("Min", DoubleValue(min));
+    fuzz->SetAttribute("Max", DoubleValue(max));
 
-    for (int i = 0; i < nAP; ++i)
+    if (offeredLoad == "full")
     {
-        wifiStaNodes[i].Create(nSTA);
-        wifiStaNodesLegacy[i].Create(nSTALegacy);
+        Ptr<FullBufferApplication> source = CreateObject<FullBufferApplication>();
+        source->SetAttribute("Protocol", TypeIdValue(TypeId::LookupByName(protocol)));
+        source->SetAttribute("Remote", AddressValue(remote));
+        source->SetAttribute("PacketSize", UintegerValue(packetSize));
+        source->SetAttribute("QueueDepth", UintegerValue(queueDepth));
+        source->SetAttribute("EnableSeqTsSizeHeader", BooleanValue(true));
+        fromNode->AddApplication(source);
+        sourceApplications.Add(source);
     }
+    else
+    {
+        OnOffHelper onOffHelper(protocol, remote);
+        onOffHelper.SetConstantRate(DataRate(offeredLoad + "Mbps"), packetSize);
+        onOffHelper.SetAttribute("EnableSeqTsSizeHeader", BooleanValue(true));
+        sourceApplications.Add(onOffHelper.Install(fromNode)); //fromNode
+    }
+    PacketSinkHelper packetSinkHelper(protocol, local);
+    packetSinkHelper.SetAttribute("EnableSeqTsSizeHeader", BooleanValue(true));
+    sinkApplications.Add(packetSinkHelper.Install(toNode)); //toNode
 
-    // SpectrumWifiPhyHelper spectrumPhy;
-    // Ptr<MultiModelSpectrumChannel> spectrumChannel = CreateObject<MultiModelSpectrumChannel>();
-    // Ptr<FriisPropagationLossModel> lossModel = CreateObject<FriisPropagationLossModel>();
-    // spectrumChannel->AddPropagationLossModel(lossModel);
-    // Ptr<ConstantSpeedPropagationDelayModel> delayModel = CreateObject<ConstantSpeedPropagationDelayModel>();
-    // spectrumChannel->SetPropagationDelayModel(delayModel);
+    sinkApplications.Start(Seconds(warmupTime));
+    sinkApplications.Stop(Seconds(simulationTime));
+    sourceApplications.Start(Seconds(warmupTime + fuzz->GetValue()));
+    sourceApplications.Stop(Seconds(simulationTime));
 
-    // spectrumPhy.SetChannel(spectrumChannel);
-    // spectrumPhy.SetErrorRateModel("ns3::YansErrorRateModel");
-    // // spectrumPhy.Set ("ChannelSettings", StringValue ("{171, 80, BAND_5GHZ, 0}"));
-    // spectrumPhy.Set ("ChannelSettings", StringValue ("{36, 20, BAND_5GHZ, 0}"));
+    flow.destination = addr;
+    flow.port = port;
+    flow.ac = QosUtilsMapTidToAc(tosValue >> 5);
+    return {flows.Register(flow), sourceApplications.Get(0), DynamicCast<PacketSink>(sinkApplications.Get(0))};
+}
 
-    // spectrumPhy.Set("Frequency", UintegerValue(5180)); // channel 36 at 20 MHz
-    // spectrumPhy.Set("ChannelWidth", UintegerValue(20));
-    // // spectrumPhy.Set("ChannelWidth", UintegerValue(20));
-    // spectrumPhy.Set("ChannelNumber", UintegerValue (36));
-    // spectrumPhy.SetPreambleDetectionModel("ns3::ThresholdPreambleDetectionModel",
-    //                                     "MinimumRssi", DoubleValue (minimumRssi));
+/* the parameters a variant may change at the warmup checkpoint; everything else must match the base */
+const std::vector<std::string> variantParameters = {"obssPdThreshold", "offeredLoad", "stopRelError"};
 
+void CheckVariant(const SimulationParameters &base, const SimulationParameters &variant)
+{
+    RunParameters a = DescribeParameters(base);
+    RunParameters b = DescribeParameters(variant);
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        bool mayDiffer = std::find(variantParameters.begin(), variantParameters.end(), a[i].first) != variantParameters.end();
+        NS_ABORT_MSG_IF(!mayDiffer && a[i].second != b[i].second,
+                        "A variant cannot change " << a[i].first << " (" << a[i].second << " -> " << b[i].second << ")");
+    }
+    NS_ABORT_MSG_IF((base.offeredLoad == "full") != (variant.offeredLoad == "full"),
+                    "A variant cannot switch between a full-buffer and a constant-rate source");
+}
 
-/****** YansWifiChannelHelper *******/
-//error 2 WifiPhy: initial value cannot be set using attributes
-    YansWifiPhyHelper spectrumPhy;
-    Ptr<YansWifiChannel> spectrumChannel;
-    YansWifiChannelHelper channelHelper = YansWifiChannelHelper::Default ();
-    //std::string channelStr ("{0, " + std::to_string (20) + ", ");
-    //channelStr += "BAND_5GHZ, 0}";
-    spectrumChannel = channelHelper.Create ();
-    spectrumChannel->SetPropagationLossModel (CreateObject<FriisPropagationLossModel>());
+/* in a child forked at the checkpoint: OBSS PD level of every device and rate of the OnOff sources */
+void ApplyVariant(const SimulationParameters &variant, const std::vector<TrafficFlow> &trafficFlows)
+{
+    for (auto node = NodeList::Begin(); node != NodeList::End(); ++node)
+    {
+        for (uint32_t d = 0; d < (*node)->GetNDevices(); d++)
+        {
+            Ptr<ObssPdAlgorithm> obssPd = (*node)->GetDevice(d)->GetObject<ObssPdAlgorithm>();
+            if (obssPd)
+            {
+                obssPd->SetAttribute("ObssPdLevel", DoubleValue(variant.obssPdThreshold));
+            }
+        }
+    }
+    if (variant.offeredLoad != "full")
+    {
+        for (const TrafficFlow &flow : trafficFlows)
+        {
+            flow.source->SetAttribute("DataRate", DataRateValue(DataRate(variant.offeredLoad + "Mbps")));
+        }
+    }
+}
 
-    //change it for buildings
-    //channelHelper.AddPropagationLoss("ns3::OhBuildingsPropagationLossModel");
-    //channelHelper.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
-    //spectrumChannel = channelHelper.Create ();
+/*
+ * Build the whole scenario for one parameter point, run it and tear it down again. With `variants`
+ * (see CheckVariant) the setup and the warmup run once; each variant then runs the measurement phase in
+ * a child forked at the end of the warmup, and the results come back in variant order.
+ */
+std::vector<SimulationResults> RunScenario(const SimulationParameters &params, const std::vector<SimulationParameters> &variants)
+{
+    // ru_maxrss never goes down: a run's peak is only known if it raised the process peak above this
+    struct rusage startUsage;
+    getrusage(RUSAGE_SELF, &startUsage);
+    if (params.profile)
+    {
+        UseProfilingSimulator();
+    }
+    double duration = params.duration;
+    double d1 = params.d1;
+    double d2 = params.d2;
+    double powSta = params.powSta;
+    double powAp = params.powAp;
+    double ccaEdTrSta = params.ccaEdTrSta;
+    double ccaEdTrAp = params.ccaEdTrAp;
+    uint32_t mcs = params.mcs;
+    uint32_t mcsLegacy = params.mcsLegacy;
+    bool enableObssPd = params.enableObssPd;
+    double obssPdThreshold = params.obssPdThreshold;
+    int packetSize = params.packetSize;
+    int nSTA = params.nSTA;
+    int nSTALegacy = params.nSTALegacy;
+    const int nAP = params.nAP;
+    std::string offeredLoad = params.offeredLoad;
+    uint32_t queueDepth = params.queueDepth;
+    int simulationTime = params.simulationTime;
+    int warmupTime = params.warmupTime;
+    bool BE = params.BE;
+    bool rtsCts = params.rtsCts;
+    double minimumRssi = params.minimumRssi;
+    bool verbose = params.verbose;
+
+    /* every run starts from the same global state, so a point run inside a
+     * sweep gives the same numbers as the same point run on its own */
+    RngSeedManager::SetRun(params.rngRun);
+    RngSeedManager::ResetNextStreamIndex();
+    Ipv4AddressGenerator::Reset();
 
+    NS_LOG_INFO("Creating node containers");
+    SetupTimer setupTimer;
+    TopologyParameters topologyParams;
+    topologyParams.layout = params.layout;
+    topologyParams.staPlacement = params.staPlacement;
+    topologyParams.nAP = nAP;
+    topologyParams.apDistance = d1;
+    topologyParams.staDistance = d2;
+    topologyParams.reverse = params.reverseBss;
+    topologyParams.stream = PLACEMENT_STREAM;
+    topologyParams.nSta = ParseStationCounts(params.staCounts, nAP, nSTA);
+    topologyParams.nStaLegacy = ParseStationCounts(params.staCountsLegacy, nAP, nSTALegacy);
+    BssTopology topology(topologyParams);
+    topology.CreateNodes();
+    setupTimer.Mark("nodes");
+
+/****** PHY backend *******/
+    // Yans, or spectrum PHYs on a MultiModelSpectrumChannel; everything from here on is the same for both
+    bool spectrum = params.phy == "spectrum";
+    NS_ABORT_MSG_IF(!spectrum && params.phy != "yans", "Unknown phy \"" << params.phy << "\", use yans or spectrum");
+    // Friis by default, the wall scenarios chain LogDistance and OhBuildings
+    Ptr<PropagationLossModel> lossModel = BuildLossModel(params.lossModels);
+    YansWifiPhyHelper yansPhy;
+    SpectrumWifiPhyHelper spectrumPhy;
+    Ptr<YansWifiChannel> yansChannel;
+    Ptr<MultiModelSpectrumChannel> spectrumChannel;
+    if (spectrum)
+    {
+        // the loss and delay models go on after mobility, see below
+        spectrumChannel = CreateObject<MultiModelSpectrumChannel>();
+        spectrumPhy.SetChannel(spectrumChannel);
+    }
+    else
+    {
+        YansWifiChannelHelper channelHelper = YansWifiChannelHelper::Default ();
+        yansChannel = channelHelper.Create ();
+        yansChannel->SetPropagationLossModel (lossModel);
+        yansPhy.SetChannel (yansChannel);
+    }
     //ComponentEnable("OhBuildingsPropagationLossModel", LOG_LEVEL_ALL);
 
-    spectrumPhy.SetChannel (spectrumChannel);
-    spectrumPhy.SetPreambleDetectionModel ("ns3::ThresholdPreambleDetectionModel",
+    // both keep the default channel of 802.11ax in the 5 GHz band and the default error rate model
+    WifiPhyHelper &wifiPhy = spectrum ? static_cast<WifiPhyHelper &>(spectrumPhy) : yansPhy;
+    wifiPhy.SetPreambleDetectionModel ("ns3::ThresholdPreambleDetectionModel",
                                          "MinimumRssi", DoubleValue (minimumRssi));
-    // spectrumPhy.Set ("ChannelSettings", StringValue(channelStr));
-    //2spectrumPhy.Set("ChannelNumber", UintegerValue (36));
-    //spectrumPhy.Set("ChannelWidth", UintegerValue(20));
-    //spectrumPhy.Set("Frequency", UintegerValue(5180)); // channel 36 at 20 MHz
-    //freq removed
-
-    spectrumPhy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11_RADIO);
+    wifiPhy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11_RADIO);
 
 /************** 802.11AX ****************/
 
@@ -276,15 +377,12 @@ int main(int argc, char *argv[])
 
     /***************** BSS  *****************/
 
-    NetDeviceContainer staDevices[nAP];
-    NetDeviceContainer staDevicesLegacy[nAP];
-    NetDeviceContainer apDevices;
-
     for (int i = 0; i < nAP; i++){
-        spectrumPhy.Set("TxPowerStart", DoubleValue(powSta));
-        spectrumPhy.Set("TxPowerEnd", DoubleValue(powSta));
-        spectrumPhy.Set("CcaEdThreshold", DoubleValue(ccaEdTrSta));
-        spectrumPhy.Set("RxSensitivity", DoubleValue(-92.0));
+        BssNodes &bss = topology.GetBss(i);
+        wifiPhy.Set("TxPowerStart", DoubleValue(powSta));
+        wifiPhy.Set("TxPowerEnd", DoubleValue(powSta));
+        wifiPhy.Set("CcaEdThreshold", DoubleValue(ccaEdTrSta));
+        wifiPhy.Set("RxSensitivity", DoubleValue(-92.0));
 
         // spectrumPhyLegacy.Set("TxPowerStart", DoubleValue(powSta));
         // spectrumPhyLegacy.Set("TxPowerEnd", DoubleValue(powSta));
@@ -299,34 +397,35 @@ int main(int argc, char *argv[])
         NetDeviceContainer staDevice;
         NetDeviceContainer staDeviceLegacy;
 
-        staDevice = wifi.Install(spectrumPhy, mac, wifiStaNodes[i]);
-        staDeviceLegacy = wifiLegacy.Install(spectrumPhy, mac, wifiStaNodesLegacy[i]);
+        staDevice = wifi.Install(wifiPhy, mac, bss.sta);
+        staDeviceLegacy = wifiLegacy.Install(wifiPhy, mac, bss.staLegacy);
 
-        staDevices[i].Add(staDevice);
-        staDevicesLegacy[i].Add(staDeviceLegacy);
+        bss.staDevices.Add(staDevice);
+        bss.staDevicesLegacy.Add(staDeviceLegacy);
 
-        spectrumPhy.Set("TxPowerStart", DoubleValue(powAp));
-        spectrumPhy.Set("TxPowerEnd", DoubleValue(powAp));
-        spectrumPhy.Set("CcaEdThreshold", DoubleValue(ccaEdTrAp));
-        spectrumPhy.Set("RxSensitivity", DoubleValue(-92.0));
+        wifiPhy.Set("TxPowerStart", DoubleValue(powAp));
+        wifiPhy.Set("TxPowerEnd", DoubleValue(powAp));
+        wifiPhy.Set("CcaEdThreshold", DoubleValue(ccaEdTrAp));
+        wifiPhy.Set("RxSensitivity", DoubleValue(-92.0));
 
         mac.SetType("ns3::ApWifiMac",
                     "QosSupported", BooleanValue(true),
                     "Ssid", SsidValue(ssid));
-        NetDeviceContainer apDevice = wifi.Install(spectrumPhy, mac, wifiApNodes.Get(i));
-        apDevices.Add(apDevice);
+        NetDeviceContainer apDevice = wifi.Install(wifiPhy, mac, bss.ap);
+        bss.apDevice.Add(apDevice);
 
         Ptr<WifiNetDevice> apDevice_i = apDevice.Get(0)->GetObject<WifiNetDevice>();
         Ptr<ApWifiMac> apWifiMac = apDevice_i->GetMac()->GetObject<ApWifiMac>();
         if (enableObssPd)
         {
-            apDevice_i->GetHeConfiguration()->SetAttribute("BssColor", UintegerValue(i+1));
+            apDevice_i->GetHeConfiguration()->SetAttribute("BssColor", UintegerValue(bss.color));
         }
     }
 
     for (int i=0; i < nAP; i++){
-        for (int j=0; j < nSTA; j++){
-            Ptr<NetDevice> dev = wifiStaNodes[i].Get (j)->GetDevice (0);
+        BssNodes &bss = topology.GetBss(i);
+        for (uint32_t j=0; j < bss.sta.GetN(); j++){
+            Ptr<NetDevice> dev = bss.staDevices.Get (j);
             Ptr<WifiNetDevice> wifi_dev = DynamicCast<WifiNetDevice> (dev);
             // wifi_dev->GetMac ()->SetAttribute ("BE_MaxAmpduSize", UintegerValue (65535));
             // wifi_dev->GetMac ()->SetAttribute ("BE_MaxAmsduSize", UintegerValue (3000));
@@ -335,15 +434,15 @@ int main(int argc, char *argv[])
 
 
         }
-        for (int j=0; j < nSTALegacy; j++){
-            Ptr<NetDevice> dev = wifiStaNodesLegacy[i].Get (j)->GetDevice (0);
+        for (uint32_t j=0; j < bss.staLegacy.GetN(); j++){
+            Ptr<NetDevice> dev = bss.staDevicesLegacy.Get (j);
             Ptr<WifiNetDevice> wifi_dev = DynamicCast<WifiNetDevice> (dev);
             // wifi_dev->GetMac ()->SetAttribute ("BE_MaxAmpduSize", UintegerValue (65535));
             // wifi_dev->GetMac ()->SetAttribute ("BE_MaxAmsduSize", UintegerValue (3000));
             wifi_dev->GetMac ()->SetAttribute ("BE_MaxAmsduSize", UintegerValue (0));
             wifi_dev->GetMac ()->SetAttribute ("BE_MaxAmpduSize", UintegerValue (0));
         }
-    Ptr<NetDevice> dev = wifiApNodes.Get(i)->GetDevice (0);
+    Ptr<NetDevice> dev = bss.apDevice.Get (0);
     Ptr<WifiNetDevice> wifi_dev = DynamicCast<WifiNetDevice> (dev);
     // wifi_dev->GetMac()->SetAttribute ("BE_MaxAmpduSize", UintegerValue (65535));
     // wifi_dev->GetMac ()->SetAttribute ("BE_MaxAmsduSize", UintegerValue (3000));
@@ -351,37 +450,62 @@ int main(int argc, char *argv[])
     wifi_dev->GetMac ()->SetAttribute ("BE_MaxAmpduSize", UintegerValue (0));
 
     }
-    MobilityHelper mobility;
-    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
-
-    
-    positionAlloc->Add (Vector (0.0, 0.0, 1.0)); // AP1
-    for(int i=0; i<nSTA+nSTALegacy; i++){
-        positionAlloc->Add (Vector (-d2, 0.0, 1.0)); // sta1
+    setupTimer.Mark("devices");
+
+    /* line layout: AP i at (i*d1, 0), stations of BSS 1 at -d2, the others at +d2 from their AP */
+    topology.InstallMobility();
+    std::vector<Box> walls = ParseWalls(params.walls);
+    std::vector<Box> midWalls = MidpointWalls(topology, params.midWall);
+    walls.insert(walls.end(), midWalls.begin(), midWalls.end());
+    if (!walls.empty() || params.lossModels.find("Buildings") != std::string::npos)
+    {
+        InstallWalls(walls);
     }
+    setupTimer.Mark("mobility");
 
-    positionAlloc->Add (Vector (d1, 0.0, 1.0)); // AP2
-    for(int i=0; i<nSTA+nSTALegacy; i++){
-        positionAlloc->Add (Vector (d1+d2, 0.0, 1.0)); // sta2
+    // nodes and walls never move, evaluate the loss and the delay once per pair
+    Ptr<StaticLinkTable> linkTable;
+    if (spectrum)
+    {
+        Ptr<PropagationDelayModel> delayModel = CreateObject<ConstantSpeedPropagationDelayModel>();
+        if (params.linkCache)
+        {
+            linkTable = InstallStaticLinkCache(spectrumChannel, lossModel, delayModel, NodeContainer::GetGlobal());
+        }
+        else
+        {
+            spectrumChannel->AddPropagationLossModel(lossModel);
+            spectrumChannel->SetPropagationDelayModel(delayModel);
+        }
     }
-
-    mobility.SetPositionAllocator (positionAlloc);
-
-    for (int i = 0; i < nAP; i++){
-        mobility.Install(wifiApNodes.Get(i));
-        mobility.Install(wifiStaNodes[i]);
-        mobility.Install(wifiStaNodesLegacy[i]);
-        
+    else if (params.linkCache)
+    {
+        linkTable = InstallStaticLinkCache(yansChannel, NodeContainer::GetGlobal());
     }
 
-    // for (int i = 0; i < nAP; ++i) {
-    // BuildingsHelper::Install(wifiApNodes.Get(i));
-    // BuildingsHelper::Install(wifiStaNodes[i]);
-    // if (nSTALegacy > 0) 
-    //     {
-    //     BuildingsHelper::Install(wifiStaNodesLegacy[i]);
-    //     }
-    // }
+    // every frame only reaches the receivers in its transmitter's reach
+    if (params.cull)
+    {
+        NS_ABORT_MSG_IF(!linkTable, "--cull needs --linkCache");
+        Ptr<ReachTable> reach = Create<ReachTable>(linkTable,
+                                                   NodeContainer::GetGlobal(),
+                                                   params.cullFloor - params.cullMargin);
+        if (spectrum)
+        {
+            Ptr<ReachTransmitFilter> filter = CreateObject<ReachTransmitFilter>();
+            filter->SetReachTable(reach);
+            spectrumChannel->AddSpectrumTransmitFilter(filter);
+        }
+        else
+        {
+            CullYansChannel(reach);
+        }
+        if (verbose)
+        {
+            std::cout << "Culling: " << reach->GetMeanNeighbors() << " of " << reach->GetN() - 1
+                      << " receivers in reach per transmitter on average" << std::endl;
+        }
+    }
 
 /* umieszczenie stacji randomowo w obrebie okregu*/
     // mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
@@ -400,65 +524,80 @@ int main(int argc, char *argv[])
     // mobility.Install(wifiStaNodesLegacy[1]);
 
     /* Internet Stack */
-    InternetStackHelper stack;
-    stack.Install(wifiApNodes);
-    for(int i=0; i< nAP; i++){
-        stack.Install(wifiStaNodes[i]);
-        stack.Install(wifiStaNodesLegacy[i]);
-    }
-
-    std::cout << std::endl<< "+++++++++++++++++++++++++++++++++++++++++++" << std::endl;
-    std::cout<< "OBSS enabled: \t" << enableObssPd << std::endl;
-    std::cout<< "CTS enabled: \t" << rtsCts << std::endl;
-    std::cout<< "OBSS PD threshold: \t" << obssPdThreshold << std::endl;
-    std::cout<< "Distance betwen AP and STA: \t" << d2 << std::endl;
-    std::cout<< "Distance between AP: \t" << d1 << std::endl;
-    std::cout<< "MCS AX: \t" << mcs << std::endl;
-    std::cout<< "MCS Legacy: \t" << mcsLegacy << std::endl;
-    std::cout<< "stacje AX: \t" << nSTA << std::endl;
-    std::cout<< "stacje legacy: \t" << nSTALegacy << std::endl;
-    std::cout<< "offered Load: \t" << offeredLoad << std::endl;
-    std::cout<< "+++++++++++++++++++++++++++++++++++++++++++" << std::endl;
-    std::cout << std::endl<< "Node positions" << std::endl;
-/*wylistowanie polozenia wezlow w przestrzeni*/
-    for(int i = 0; i < nAP; i++){
-        Ptr<MobilityModel> positionAP = wifiApNodes.Get(i)->GetObject<MobilityModel>();
-        Vector pos = positionAP->GetPosition();
-        std::cout << "AP BSS: "<< i << "\tx=" << pos.x << ", y=" << pos.y << std::endl;
+    bool l2Traffic = params.l2Traffic;
+    NS_ABORT_MSG_IF(l2Traffic && params.flowMonitor, "FlowMonitor needs the IP stack, drop --flowMonitor with --l2Traffic");
+    if (l2Traffic)
+    {
+        // only a PacketSocketFactory per node, the Wi-Fi device stays device 0
+        PacketSocketHelper packetSocket;
+        packetSocket.Install(NodeContainer::GetGlobal());
     }
+    else
+    {
+        InternetStackHelper stack;
+        stack.Install(topology.GetApNodes());
+        for(int i=0; i< nAP; i++){
+            stack.Install(topology.GetBss(i).sta);
+            stack.Install(topology.GetBss(i).staLegacy);
+        }
+    }
+    setupTimer.Mark("stack");
 
-    for (int i = 0; i < nAP; i++){
-        int n = 1;
-        for (NodeContainer::Iterator j = wifiStaNodes[i].Begin(); j != wifiStaNodes[i].End(); ++j)
-        {
-            Ptr<Node> object = *j;
-            Ptr<MobilityModel> position = object->GetObject<MobilityModel>();
-            Vector pos = position->GetPosition();
-            std::cout << "BSS "<< i+1 <<", Sta " << n << ":\tx=" << pos.x << ", y=" << pos.y << std::endl;
-            n++;
+    if (verbose)
+    {
+        std::cout << std::endl<< "+++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+        std::cout<< "OBSS enabled: \t" << enableObssPd << std::endl;
+        std::cout<< "CTS enabled: \t" << rtsCts << std::endl;
+        std::cout<< "OBSS PD threshold: \t" << obssPdThreshold << std::endl;
+        std::cout<< "Distance betwen AP and STA: \t" << d2 << std::endl;
+        std::cout<< "Distance between AP: \t" << d1 << std::endl;
+        std::cout<< "MCS AX: \t" << mcs << std::endl;
+        std::cout<< "MCS Legacy: \t" << mcsLegacy << std::endl;
+        std::cout<< "stacje AX: \t" << nSTA << std::endl;
+        std::cout<< "stacje legacy: \t" << nSTALegacy << std::endl;
+        std::cout<< "offered Load: \t" << offeredLoad << std::endl;
+        std::cout<< "layout: \t" << params.layout << ", " << nAP << " BSS" << (params.reverseBss ? ", reversed" : "") << std::endl;
+        std::cout<< "loss: \t" << params.lossModels << ", " << walls.size() << " wall(s)" << std::endl;
+        std::cout<< "phy: \t" << params.phy << std::endl;
+        if (!params.scenario.empty())
+            std::cout<< "scenario: \t" << params.scenario << std::endl;
+        std::cout<< "+++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+        std::cout << std::endl<< "Node positions" << std::endl;
+    /*wylistowanie polozenia wezlow w przestrzeni*/
+        for(int i = 0; i < nAP; i++){
+            Ptr<MobilityModel> positionAP = topology.GetBss(i).ap->GetObject<MobilityModel>();
+            Vector pos = positionAP->GetPosition();
+            std::cout << "AP BSS: "<< i << "\tx=" << pos.x << ", y=" << pos.y << std::endl;
         }
-        for (NodeContainer::Iterator j = wifiStaNodesLegacy[i].Begin(); j != wifiStaNodesLegacy[i].End(); ++j)
-        {
-            Ptr<Node> object = *j;
-            Ptr<MobilityModel> position = object->GetObject<MobilityModel>();
-            Vector pos = position->GetPosition();
-            std::cout << "BSS "<< i+1 <<",  Legacy Sta " << n << ":\tx=" << pos.x << ", y=" << pos.y << std::endl;
-            n++;
+
+        for (int i = 0; i < nAP; i++){
+            int n = 1;
+            const BssNodes &bss = topology.GetBss(i);
+            for (NodeContainer::Iterator j = bss.sta.Begin(); j != bss.sta.End(); ++j)
+            {
+                Ptr<Node> object = *j;
+                Ptr<MobilityModel> position = object->GetObject<MobilityModel>();
+                Vector pos = position->GetPosition();
+                std::cout << "BSS "<< i+1 <<", Sta " << n << ":\tx=" << pos.x << ", y=" << pos.y << std::endl;
+                n++;
+            }
+            for (NodeContainer::Iterator j = bss.staLegacy.Begin(); j != bss.staLegacy.End(); ++j)
+            {
+                Ptr<Node> object = *j;
+                Ptr<MobilityModel> position = object->GetObject<MobilityModel>();
+                Vector pos = position->GetPosition();
+                std::cout << "BSS "<< i+1 <<",  Legacy Sta " << n << ":\tx=" << pos.x << ", y=" << pos.y << std::endl;
+                n++;
+            }
         }
     }
 
-    Ipv4AddressHelper address;
-    for (int i = 0; i < nAP; ++i)
+    /* BSS i in 192.168.i.0/24 (10.x.y.0/24 past 256 BSSs) */
+    if (!l2Traffic)
     {
-        std::string addr;
-        addr = "192.168." + to_string(i) + ".0";
-        const char *cstr = addr.c_str(); // convert to constant char
-        address.SetBase(Ipv4Address(cstr), "255.255.255.0");
-        address.Assign(apDevices.Get(i));
-        address.Assign(staDevices[i]);
-        address.Assign(staDevicesLegacy[i]);
-
+        topology.AssignAddresses();
     }
+    setupTimer.Mark("addresses");
 /*enable pcap*/
     // spectrumPhy.EnablePcap("1AX-isolated/1-AP", apDevices);
     // spectrumPhy.EnablePcap("1AX-isolated/1-STA1", staDevices[0]);
@@ -466,125 +605,754 @@ int main(int argc, char *argv[])
     // spectrumPhy.EnablePcap("1AX-isolated/1-STA1-legacy", staDevicesLegacy[0]);
     // spectrumPhy.EnablePcap("1AX-isolated/1-STA2-legacy", staDevicesLegacy[1]);
 
-    PopulateARPcache();
+    if (!l2Traffic)
+    {
+        InstallStaticArp(NodeContainer::GetGlobal());
+    }
+    setupTimer.Mark("arp");
+    // on layer 2 the IPv4 and UDP header bytes go into the payload, so frames and byte counts stay the same
+    if (l2Traffic)
+    {
+        packetSize += 28;
+    }
+    FlowRegistry flows;
+    FlowStatsCollector flowStats(flows, l2Traffic ? 0 : 28);
+    std::vector<TrafficFlow> trafficFlows; // by flow id
     if (BE)
     {
-        int port = 0;
+        // every AP is its own sink, so the ports restart at 1000 in each BSS
         for (int i = 0; i < nAP; ++i)
         {
-            port += 1000;
-            for (int j = 0; j < nSTA; ++j){
-                std::cout << "AX port: "<< port << std::endl; 
-                installTrafficGenerator(wifiStaNodes[i].Get(j), wifiApNodes.Get(i), port , offeredLoad, packetSize, simulationTime, warmupTime, 0x70);
+            BssNodes &bss = topology.GetBss(i);
+            int port = 1000;
+            for (uint32_t j = 0; j < bss.sta.GetN(); ++j){
+                if (verbose)
+                    std::cout << "AX port: "<< port << std::endl; 
+                FlowDescriptor flow;
+                flow.bss = i;
+                flow.sta = port - 1000;
+                flow.ax = true;
+                TrafficFlow traffic = installTrafficGenerator(bss.sta.Get(j), bss.ap, port , offeredLoad, packetSize, simulationTime, warmupTime, 0x70, queueDepth, l2Traffic, flows, flow);
+                flowStats.AddFlow(traffic.id, traffic.source, traffic.sink);
+                trafficFlows.push_back(traffic);
                 // installTrafficGenerator(wifiApNodes.Get(i),wifiStaNodes[i].Get(j) , port , offeredLoad, packetSize, simulationTime, warmupTime, 0x70);
 
                 // std::vector<uint8_t> tosValues = {0x70, 0x28, 0xb8, 0xc0}; //AC_BE, AC_BK, AC_VI, AC_VO
                 port+=2;            
             }
             port +=1;
-            for (int j =0; j< nSTALegacy; ++j){
-                std::cout << "Legacy port: "<< port << std::endl; 
-                installTrafficGenerator(wifiStaNodesLegacy[i].Get(j), wifiApNodes.Get(i), port, offeredLoad, packetSize, simulationTime, warmupTime, 0x70);
+            for (uint32_t j =0; j< bss.staLegacy.GetN(); ++j){
+                if (verbose)
+                    std::cout << "Legacy port: "<< port << std::endl; 
+                FlowDescriptor flow;
+                flow.bss = i;
+                flow.sta = port - 1000;
+                flow.ax = false;
+                TrafficFlow traffic = installTrafficGenerator(bss.staLegacy.Get(j), bss.ap, port, offeredLoad, packetSize, simulationTime, warmupTime, 0x70, queueDepth, l2Traffic, flows, flow);
+                flowStats.AddFlow(traffic.id, traffic.source, traffic.sink);
+                trafficFlows.push_back(traffic);
                 // installTrafficGenerator(wifiApNodes.Get(i),wifiStaNodesLegacy[i].Get(j), port, offeredLoad, packetSize, simulationTime, warmupTime, 0x70);
 
                 port+=2;
             }
-            port +=1;
         }
     }
 
 
 
     FlowMonitorHelper flowMonHelper;
-    Ptr<FlowMonitor> flowMonitor = flowMonHelper.InstallAll();
-
-    Simulator::Stop(Seconds(duration));
-    Simulator::Run();
-
-    Ptr<Ipv4FlowClassifier> classifier =
-        DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats();
-
-    std::string proto = "UDP";
-    //create vector of size 8 with all values 0
-    std::vector<uint64_t> txBytesPerBss = std::vector<uint64_t>(nAP, 0);
-    std::vector<uint64_t> rxBytesPerBss = std::vector<uint64_t>(nAP, 0);
-    std::vector<uint64_t> txPacketsPerBss = std::vector<uint64_t>(nAP, 0);
-    std::vector<uint64_t> rxPacketsPerBss = std::vector<uint64_t>(nAP, 0);
-    std::vector<uint64_t> lostPacketsPerBss = std::vector<uint64_t>(nAP, 0);
-    std::vector<double> throughputPerBss = std::vector<double>(nAP, 0.0);
-    double throughputAX = 0.0;
-    double throughputLegacy = 0.0;
-
-    std::vector<Time> delaySumPerBss = std::vector<Time>(nAP, Seconds(0));
-    std::vector<Time> jitterSumPerBss = std::vector<Time>(nAP, Seconds(0));
-
-    int bss;
-
-    for (std::map<FlowId, FlowMonitor::FlowStats>::iterator i = stats.begin(); i != stats.end(); i++)
-    {
-
-        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(i->first);
-
-        int port = t.destinationPort;
-        bss = port / 1000;
-
-        for(int j = 1; j <= nAP; j ++){
-            
-            if(bss == j){
-                txBytesPerBss[bss] += i->second.txBytes;
-                rxBytesPerBss[bss] += i->second.rxBytes;
-                txPacketsPerBss[bss] += i->second.txPackets;
-                rxPacketsPerBss[bss] += i->second.rxPackets;
-                lostPacketsPerBss[bss] += i->second.lostPackets;
-                throughputPerBss[bss] += (i->second.rxPackets > 0 ? i->second.rxBytes * 8.0 / (i->second.timeLastRxPacket.GetSeconds() - i->second.timeFirstTxPacket.GetSeconds()) / 1024 / 1024 : 0);
-                delaySumPerBss[bss] += i->second.delaySum;
-                jitterSumPerBss[bss] += i->second.jitterSum;
-
-                double staLoad = (i->second.rxPackets > 0 ? i->second.rxBytes * 8.0 / (i->second.timeLastRxPacket.GetSeconds() - i->second.timeFirstTxPacket.GetSeconds()) / 1024 / 1024 : 0);
-                // double deltaX, deltaY;
-                uint64_t staNo = port - bss*1000;
-
-                std::cout << "  Throughput per STA:" << staNo << "\t"<< staLoad << " Mb/s \t"<< std::endl;
-                if(port%2 == 0){
-                    throughputAX += staLoad;
-                }else{
-                    throughputLegacy +=staLoad;
-                }
+    Ptr<FlowMonitor> flowMonitor;
+    if (params.flowMonitor)
+    {
+        flowMonitor = flowMonHelper.InstallAll();
+    }
+    setupTimer.Mark("traffic");
+    if (verbose)
+    {
+        setupTimer.Print(std::cout);
+    }
+
+    // the measurement phase, from now until the run's duration or its stopping rule
+    auto measure = [&](const SimulationParameters &run) {
+        // taken here and not at the start of RunScenario: a variant must not be charged for the batches
+        // that ran before its child was forked
+        auto measureStart = std::chrono::steady_clock::now();
+        std::unique_ptr<ThroughputSampler> sampler;
+        if (!run.sampleFile.empty())
+        {
+            sampler.reset(new ThroughputSampler(Seconds(run.sampleInterval), nAP, l2Traffic ? 0 : 28));
+        }
+        std::unique_ptr<ConvergenceMonitor> convergence;
+        if (run.stopRelError > 0)
+        {
+            convergence.reset(new ConvergenceMonitor(nAP, Seconds(run.stopBatch), run.stopRelError, run.stopMinBatches));
+        }
+        for (const TrafficFlow &traffic : trafficFlows)
+        {
+            const FlowDescriptor &flow = flows.Get(traffic.id);
+            if (sampler)
+                sampler->AddStation(flow.bss, flow.sta, traffic.sink);
+            if (convergence)
+                convergence->AddStation(flow.bss, traffic.sink);
+        }
+
+        if (sampler)
+        {
+            sampler->Start(run.sampleFile, DescribeParameters(run), Seconds(run.duration));
+        }
+        if (convergence)
+        {
+            // the sources start up to 1 s after the warmup
+            convergence->Start(Seconds(warmupTime + 1));
+        }
+
+        Simulator::Stop(Seconds(run.duration) - Simulator::Now());
+        Simulator::Run();
+        double simTime = Simulator::Now().GetSeconds();
+        if (convergence && verbose)
+        {
+            std::cout << (convergence->HasConverged() ? "Converged" : "Not converged") << " after " << simTime << " s, "
+                      << convergence->GetNBatches() << " batches, relative CI half-width "
+                      << convergence->GetRelativeError() << std::endl;
+        }
+
+        if (sampler)
+        {
+            sampler->Finish();
+        }
+
+        SimulationResults results;
+        if (flowMonitor)
+        {
+            Ptr<Ipv4FlowClassifier> classifier =
+                DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
+            results = CollectFlowMonitorResults(flowMonitor, classifier, flows, nAP);
+        }
+        else
+        {
+            results = flowStats.GetResults(nAP);
+        }
 
+        if (run.profile)
+        {
+            EventProfile profile = GetEventProfile();
+            if (verbose)
+            {
+                profile.Print(std::cout);
             }
+            std::ofstream profileOut(run.profileFile, std::ios::app);
+            profile.WriteJson(profileOut, DescribeParameters(run));
+        }
 
+        results.simTime = simTime;
+        results.setupTime = setupTimer.GetTotal();
+        results.wallTime =
+            results.setupTime + std::chrono::duration<double>(std::chrono::steady_clock::now() - measureStart).count();
+        results.events = Simulator::GetEventCount();
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        // 0 after a larger earlier run of this process (in-process sweeps and drops), whose peak it would repeat
+        results.peakRss = usage.ru_maxrss > startUsage.ru_maxrss ? usage.ru_maxrss / 1024.0 : 0.0;
+        if (verbose)
+        {
+            std::string peak = results.peakRss > 0 ? FormatPeakRss(results.peakRss) + " MiB" : "not known";
+            std::cout << "Run cost (" << run.phy << "): " << results.wallTime << " s wall, " << results.events
+                      << " events, peak RSS " << peak << std::endl;
         }
+        return results;
+    };
 
+    std::vector<SimulationResults> allResults;
+    if (variants.empty())
+    {
+        allResults.push_back(measure(params));
+    }
+    else
+    {
+        for (const SimulationParameters &variant : variants)
+        {
+            CheckVariant(params, variant);
+        }
+        NS_ABORT_MSG_IF(!params.sampleFile.empty() && params.forkJobs > 1,
+                        "Variants running side by side would interleave their blocks in sampleFile, use forkJobs=1");
+        // checkpoint: associated, sinks up and the sources about to start
+        Simulator::Stop(Seconds(warmupTime));
+        Simulator::Run();
+        setupTimer.Mark("warmup");
+        if (verbose)
+        {
+            setupTimer.Print(std::cout);
+        }
+        std::cout.flush();
+        allResults = ForkVariants(variants.size(), params.forkJobs, [&](uint32_t v) {
+            ApplyVariant(variants[v], trafficFlows);
+            return measure(variants[v]);
+        });
     }
 
-    if (BE)
+    Simulator::Destroy();
+    return allResults;
+}
+
+/* build the whole scenario for one parameter point, run it and tear it down again */
+SimulationResults RunSimulation(const SimulationParameters &params)
+{
+    return RunScenario(params, {}).front();
+}
+
+/* the human readable report the Sym_* drivers scrape */
+void PrintResults(const SimulationParameters &params, const SimulationResults &results)
+{
+    for (const FlowResult &flow : results.flows)
     {
-            double totalThroughput = 0.0;
-        for (int i = 1; i <= nAP; i++){
-            std::cout << "======================= BSS " << i << "======================" << std::endl;
-            std::cout << "  Throughput:\t" << throughputPerBss[i] << " Mb/s" << std::endl;
-            totalThroughput += throughputPerBss[i];
-            std::cout << "  Packet loss:\t" << lostPacketsPerBss[i] << " packets" << std::endl;
-            std::cout << "  Delay:\t" << delaySumPerBss[i] << " seconds" << std::endl;
-            
+        std::cout << "  Throughput per STA:" << flow.sta << "\t"<< flow.throughput << " Mb/s \t"<< '\n';
+    }
+
+    if (params.BE)
+    {
+        for (int i = 0; i < params.nAP; i++){
+            std::cout << "======================= BSS " << i + 1 << "======================" << '\n';
+            std::cout << "  Throughput:\t" << results.bss[i].throughput << " Mb/s" << '\n';
+            std::cout << "  Packet loss:\t" << results.bss[i].lostPackets << " packets" << '\n';
+            std::cout << "  Delay:\t" << Seconds(results.bss[i].delaySum) << " seconds" << '\n';
         }
-        std::cout << "******************************************************" << std::endl;
-        std::cout << "   AX Throughput:\t" << throughputAX << " Mb/s" << std::endl;
-        std::cout << "   LEGACY Throughput:\t" << throughputLegacy << " Mb/s" << std::endl;
-        std::cout << "   TOTAL Throughput:\t" << totalThroughput << " Mb/s" << std::endl;
-        // std::cout << "  Throughput BSS 2:\t" << throughputPerBss2 << " Mb/s" << std::endl;
+        std::cout << "******************************************************" << '\n';
+        std::cout << "   AX Throughput:\t" << results.throughputAX << " Mb/s" << '\n';
+        std::cout << "   LEGACY Throughput:\t" << results.throughputLegacy << " Mb/s" << '\n';
+        std::cout << "   TOTAL Throughput:\t" << results.totalThroughput << " Mb/s" << '\n';
     }
+    std::cout.flush();
+}
 
-    // double totalThroughput = throughputPerBssLegacy[1] + throughputPerBssLegacy[2];
-    //     std::cout << "******************************************************" << std::endl;
-    //     std::cout << "   AX Throughput:\t" << throughputPerBssLegacy[1] << " Mb/s" << std::endl;
-    //     std::cout << "   LEGACY Throughput:\t" << throughputPerBssLegacy[2] << " Mb/s" << std::endl;
-    //     std::cout << "   TOTAL Throughput:\t" << totalThroughput << " Mb/s" << std::endl;
-    //     // std::cout << "  Throughput BSS 2:\t" << throughputPerBss2 << " Mb/s" << std::endl;
+/* the same point on every PHY backend: results and what each one cost */
+void PrintBackendComparison(const std::vector<SimulationParameters> &runs, const std::vector<SimulationResults> &results)
+{
+    std::cout << "PHY backend\tTOTAL Throughput (Mb/s)\twall time (s)\tevents\tpeak RSS (MiB)" << '\n';
+    for (size_t b = 0; b < runs.size(); b++)
+    {
+        std::cout << runs[b].phy << "\t" << results[b].totalThroughput << "\t" << results[b].wallTime << "\t"
+                  << results[b].events << "\t" << FormatPeakRss(results[b].peakRss) << '\n';
+    }
+    if (results.size() == 2 && results[0].wallTime > 0 && results[0].events > 0)
+    {
+        std::cout << runs[1].phy << "/" << runs[0].phy << ":\twall time x" << results[1].wallTime / results[0].wallTime
+                  << ", events x" << double(results[1].events) / results[0].events << '\n';
+    }
+    std::cout.flush();
+}
 
+/* parameters of a run as written to the results file */
+RunParameters DescribeParameters(const SimulationParameters &params)
+{
+    return {{"scenario", params.scenario},
+            {"duration", FormatParameter(params.duration)},
+            {"d1", FormatParameter(params.d1)},
+            {"d2", FormatParameter(params.d2)},
+            {"powSta", FormatParameter(params.powSta)},
+            {"powAp", FormatParameter(params.powAp)},
+            {"mcs", FormatParameter(params.mcs)},
+            {"mcsLegacy", FormatParameter(params.mcsLegacy)},
+            {"enableObssPd", FormatParameter(params.enableObssPd)},
+            {"obssPdThreshold", FormatParameter(params.obssPdThreshold)},
+            {"packetSize", FormatParameter(params.packetSize)},
+            {"nSTA", FormatParameter(params.nSTA)},
+            {"nSTALegacy", FormatParameter(params.nSTALegacy)},
+            {"nAP", FormatParameter(params.nAP)},
+            {"layout", params.layout},
+            {"staPlacement", params.staPlacement},
+            {"staCounts", params.staCounts},
+            {"staCountsLegacy", params.staCountsLegacy},
+            {"reverseBss", FormatParameter(params.reverseBss)},
+            {"lossModels", params.lossModels},
+            {"walls", params.walls},
+            {"midWall", params.midWall},
+            {"phy", params.phy},
+            {"offeredLoad", params.offeredLoad},
+            {"queueDepth", FormatParameter(params.queueDepth)},
+            {"simulationTime", FormatParameter(params.simulationTime)},
+            {"warmupTime", FormatParameter(params.warmupTime)},
+            {"stopRelError", FormatParameter(params.stopRelError)},
+            {"flowMonitor", FormatParameter(params.flowMonitor)},
+            {"l2Traffic", FormatParameter(params.l2Traffic)},
+            {"rtsCts", FormatParameter(params.rtsCts)},
+            {"rngRun", FormatParameter(params.rngRun)}};
+}
 
-    Simulator::Destroy();
+/*
+ * every value the results of a run depend on, resolved from the defaults, the scenario file and the command
+ * line: what --printParameters prints and bss_cache.py keys a run on
+ */
+RunParameters ResolvedParameters(const SimulationParameters &params)
+{
+    RunParameters resolved;
+    for (const auto &p : DescribeParameters(params))
+    {
+        // only the values read from the file matter, not its name
+        if (p.first != "scenario")
+        {
+            resolved.push_back(p);
+        }
+    }
+    resolved.insert(resolved.end(),
+                    {{"interval", FormatParameter(params.interval)},
+                     {"ccaEdTrSta", FormatParameter(params.ccaEdTrSta)},
+                     {"ccaEdTrAp", FormatParameter(params.ccaEdTrAp)},
+                     {"minimumRssi", FormatParameter(params.minimumRssi)},
+                     {"BE", FormatParameter(params.BE)},
+                     {"r", FormatParameter(params.r)},
+                     {"linkCache", FormatParameter(params.linkCache)},
+                     {"cull", FormatParameter(params.cull)},
+                     {"cullFloor", FormatParameter(params.cullFloor)},
+                     {"cullMargin", FormatParameter(params.cullMargin)},
+                     {"stopBatch", FormatParameter(params.stopBatch)},
+                     {"stopMinBatches", FormatParameter(params.stopMinBatches)}});
+    return resolved;
+}
+
+/* "a,b,c" is a list, "start:stop:step" a range with stop excluded (like np.arange) */
+std::vector<double> ParseSweepValues(const std::string &spec)
+{
+    std::vector<double> values;
+    if (spec.find(':') != std::string::npos)
+    {
+        double start, stop, step;
+        char c1, c2;
+        std::istringstream iss(spec);
+        if (!(iss >> start >> c1 >> stop >> c2 >> step) || c1 != ':' || c2 != ':' || step <= 0)
+        {
+            NS_FATAL_ERROR("Bad sweep range \"" << spec << "\", expected start:stop:step");
+        }
+        for (double v = start; v < stop - step * 1e-9; v += step)
+        {
+            values.push_back(v);
+        }
+        return values;
+    }
+    std::istringstream iss(spec);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        if (item == "true" || item == "True")
+            values.push_back(1);
+        else if (item == "false" || item == "False")
+            values.push_back(0);
+        else if (!item.empty())
+            values.push_back(std::stod(item));
+    }
+    return values;
+}
+
+/* "obssPdThreshold=-82,-72;offeredLoad=50,100": every combination, applied to a copy of `base` */
+std::vector<SimulationParameters> BuildVariants(const SimulationParameters &base, const std::string &spec)
+{
+    std::vector<SimulationParameters> variants = {base};
+    std::istringstream axes(spec);
+    std::string axis;
+    while (std::getline(axes, axis, ';'))
+    {
+        size_t eq = axis.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos, "Bad variant axis \"" << axis << "\", expected name=a,b,c");
+        std::string name = axis.substr(0, eq);
+        std::vector<std::string> values;
+        std::istringstream items(axis.substr(eq + 1));
+        std::string value;
+        while (std::getline(items, value, ','))
+        {
+            values.push_back(value);
+        }
+        std::vector<SimulationParameters> expanded;
+        for (const SimulationParameters &variant : variants)
+        {
+            for (const std::string &v : values)
+            {
+                expanded.push_back(variant);
+                SimulationParameters &p = expanded.back();
+                if (name == "obssPdThreshold")
+                    p.obssPdThreshold = std::stod(v);
+                else if (name == "offeredLoad")
+                    p.offeredLoad = v;
+                else if (name == "stopRelError")
+                    p.stopRelError = std::stod(v);
+                else
+                    NS_FATAL_ERROR("Cannot vary " << name << " after the warmup, only obssPdThreshold, offeredLoad and stopRelError");
+            }
+        }
+        variants = expanded;
+    }
+    return variants;
+}
+
+/* run every point of the grid back to back in this process and write one table */
+void RunSweep(SimulationParameters params, const std::string &sweepD1, const std::string &sweepD2,
+              const std::string &sweepObssPdThreshold, const std::string &sweepEnableObssPd,
+              uint32_t sweepRuns, const std::string &sweepFile, ResultsSink *sink)
+{
+    std::vector<double> d1s = sweepD1.empty() ? std::vector<double>{params.d1} : ParseSweepValues(sweepD1);
+    std::vector<double> d2s = sweepD2.empty() ? std::vector<double>{params.d2} : ParseSweepValues(sweepD2);
+    std::vector<double> thresholds = sweepObssPdThreshold.empty() ? std::vector<double>{params.obssPdThreshold}
+                                                                  : ParseSweepValues(sweepObssPdThreshold);
+    std::vector<double> enables = sweepEnableObssPd.empty() ? std::vector<double>{params.enableObssPd ? 1.0 : 0.0}
+                                                            : ParseSweepValues(sweepEnableObssPd);
+    uint32_t rngRunBase = params.rngRun;
+    params.verbose = false;
+
+    std::ofstream out(sweepFile);
+    if (!out)
+    {
+        NS_FATAL_ERROR("Cannot open sweep output file " << sweepFile);
+    }
+    out << "d1,d2,enableObssPd,obssPdThreshold,rngRun,throughputAX,throughputLegacy,totalThroughput";
+    for (int i = 0; i < params.nAP; i++)
+    {
+        out << ",throughputBss" << i + 1 << ",lostPacketsBss" << i + 1;
+    }
+    out << ",wallTime,events,peakRss\n";
+
+    for (double d1 : d1s)
+    {
+        for (double d2 : d2s)
+        {
+            for (double enable : enables)
+            {
+                // with OBSS_PD off the threshold does not matter, run the point only once
+                std::vector<double> pointThresholds = enable != 0 ? thresholds : std::vector<double>{params.obssPdThreshold};
+                for (uint32_t k = 0; k < sweepRuns; k++)
+                {
+                    params.d1 = d1;
+                    params.d2 = d2;
+                    params.enableObssPd = enable != 0;
+                    params.rngRun = rngRunBase + k;
+                    std::vector<SimulationParameters> variants;
+                    for (double threshold : pointThresholds)
+                    {
+                        variants.push_back(params);
+                        variants.back().obssPdThreshold = threshold;
+                    }
+
+                    // with checkpoint the thresholds share setup and warmup
+                    std::vector<SimulationResults> pointResults;
+                    if (params.checkpoint && variants.size() > 1)
+                    {
+                        pointResults = RunScenario(variants.front(), variants);
+                    }
+                    else
+                    {
+                        for (const SimulationParameters &variant : variants)
+                        {
+                            pointResults.push_back(RunSimulation(variant));
+                        }
+                    }
+
+                    for (size_t v = 0; v < variants.size(); v++)
+                    {
+                        double threshold = variants[v].obssPdThreshold;
+                        const SimulationResults &results = pointResults[v];
+                        out << d1 << "," << d2 << "," << params.enableObssPd << "," << threshold << ","
+                            << params.rngRun << "," << results.throughputAX << "," << results.throughputLegacy << ","
+                            << results.totalThroughput;
+                        for (int i = 0; i < params.nAP; i++)
+                        {
+                            out << "," << results.bss[i].throughput << "," << results.bss[i].lostPackets;
+                        }
+                        out << "," << results.wallTime << "," << results.events << "," << FormatPeakRss(results.peakRss)
+                            << "\n";
+                        out.flush(); // keep finished points if the sweep gets killed
+                        if (sink)
+                        {
+                            sink->Write(DescribeParameters(variants[v]), results);
+                            sink->Flush();
+                        }
+
+                        std::cout << "d1=" << d1 << " d2=" << d2 << " enableObssPd=" << params.enableObssPd
+                                  << " obssPdThreshold=" << threshold << " rngRun=" << params.rngRun
+                                  << "\tTOTAL Throughput:\t" << results.totalThroughput << " Mb/s\t("
+                                  << results.wallTime << " s)" << std::endl;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* value below which a fraction q of the sorted `values` lie, interpolated */
+double Quantile(const std::vector<double> &values, double q)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    double pos = q * (values.size() - 1);
+    size_t i = static_cast<size_t>(pos);
+    return i + 1 < values.size() ? values[i] + (pos - i) * (values[i + 1] - values[i]) : values[i];
+}
+
+/*
+ * Monte Carlo over station positions: `drops` runs with the stations placed
+ * uniformly in their disc, drop k with rngRun + k, i.e. substream k of the
+ * placement stream and of every other one. The drops run in this process,
+ * forkJobs of them side by side. One line per drop goes to dropsFile, the
+ * distribution of the total and per-BSS throughput over the drops to stdout.
+ */
+void RunDrops(SimulationParameters params, uint32_t drops, const std::string &dropsFile, ResultsSink *sink)
+{
+    params.staPlacement = "disc";
+    params.verbose = false;
+    std::vector<SimulationParameters> runs(drops, params);
+    for (uint32_t k = 0; k < drops; k++)
+    {
+        runs[k].rngRun = params.rngRun + k;
+    }
+
+    std::vector<SimulationResults> results;
+    if (params.forkJobs > 1)
+    {
+        std::cout.flush();
+        results = ForkVariants(drops, params.forkJobs, [&](uint32_t k) { return RunSimulation(runs[k]); });
+    }
+    else
+    {
+        for (const SimulationParameters &run : runs)
+        {
+            results.push_back(RunSimulation(run));
+        }
+    }
+
+    std::ofstream out(dropsFile);
+    if (!out)
+    {
+        NS_FATAL_ERROR("Cannot open drops output file " << dropsFile);
+    }
+    out << "drop,rngRun,throughputAX,throughputLegacy,totalThroughput";
+    for (int i = 0; i < params.nAP; i++)
+    {
+        out << ",throughputBss" << i + 1;
+    }
+    out << ",wallTime\n";
+    // one distribution for the total, then one per BSS
+    std::vector<std::vector<double>> samples(params.nAP + 1);
+    for (uint32_t k = 0; k < drops; k++)
+    {
+        const SimulationResults &r = results[k];
+        out << k << "," << runs[k].rngRun << "," << r.throughputAX << "," << r.throughputLegacy << ","
+            << r.totalThroughput;
+        samples[0].push_back(r.totalThroughput);
+        for (int i = 0; i < params.nAP; i++)
+        {
+            out << "," << r.bss[i].throughput;
+            samples[i + 1].push_back(r.bss[i].throughput);
+        }
+        out << "," << r.wallTime << "\n";
+        if (sink)
+        {
+            sink->Write(DescribeParameters(runs[k]), r);
+        }
+    }
+
+    std::cout << drops << " drops, rngRun " << params.rngRun << " to " << params.rngRun + drops - 1 << '\n';
+    std::cout << "Throughput (Mb/s)\tmean\tstd\tmin\tp5\tp50\tp95\tmax" << '\n';
+    for (size_t s = 0; s < samples.size(); s++)
+    {
+        std::vector<double> &v = samples[s];
+        std::sort(v.begin(), v.end());
+        double mean = std::accumulate(v.begin(), v.end(), 0.0) / v.size();
+        double var = 0;
+        for (double x : v)
+        {
+            var += (x - mean) * (x - mean);
+        }
+        double sd = v.size() > 1 ? std::sqrt(var / (v.size() - 1)) : 0.0;
+        std::cout << (s == 0 ? std::string("TOTAL") : "BSS " + std::to_string(s)) << "\t" << mean << "\t" << sd
+                  << "\t" << v.front() << "\t" << Quantile(v, 0.05) << "\t" << Quantile(v, 0.5) << "\t"
+                  << Quantile(v, 0.95) << "\t" << v.back() << '\n';
+    }
+    std::cout.flush();
+}
+
+int main(int argc, char *argv[])
+{
+    NS_LOG_UNCOND("Starting the WiFi BSS Simulation");
+    SimulationParameters params;
+    std::string sweepD1;
+    std::string sweepD2;
+    std::string sweepObssPdThreshold;
+    std::string sweepEnableObssPd;
+    uint32_t sweepRuns = 1;
+    std::string variantSpec;
+    uint32_t drops = 0;
+    std::string dropsFile = "drops.csv";
+    std::string sweepFile = "sweep_results.csv";
+    std::string resultsFile;
+    std::string resultsFormat = "csv";
+    bool printParameters = false;
+
+
+    CommandLine cmd(__FILE__);
+
+    cmd.AddValue("scenario", "Read option defaults from this file of name = value lines (see bss-scenario.h)", params.scenario);
+    cmd.AddValue("duration", "Duration of simulation (s)", params.duration);
+    cmd.AddValue("interval", "Inter packet interval (s)", params.interval);
+    cmd.AddValue("enableObssPd", "Enable/disable OBSS_PD", params.enableObssPd);
+    cmd.AddValue("obssPdThreshold", "obssPdThreshold", params.obssPdThreshold);
+    cmd.AddValue("d1", "Distance between AP1 and AP2 (m)", params.d1); //most likely D1
+    cmd.AddValue("d3", "Same as d1 (its name in the wall scenario)", params.d1);
+    cmd.AddValue("d2", "Distance between AP and STA (m)", params.d2);
+    cmd.AddValue("mcs", "The constant MCS value to transmit HE PPDUs", params.mcs);
+    cmd.AddValue("mcsLegacy", "The constant MCS value to transmit HE PPDUs", params.mcsLegacy);
+    cmd.AddValue("powSta", "Station transmit power (dBm)", params.powSta);
+    cmd.AddValue("powAp", "AP transmit power (dBm)", params.powAp);
+    cmd.AddValue("ccaEdTrSta", "Station CCA energy detection threshold (dBm)", params.ccaEdTrSta);
+    cmd.AddValue("ccaEdTrAp", "AP CCA energy detection threshold (dBm)", params.ccaEdTrAp);
+    cmd.AddValue("minimumRssi", "Preamble detection threshold (dBm)", params.minimumRssi);
+    cmd.AddValue("packetSize", "UDP payload per packet (bytes)", params.packetSize);
+    cmd.AddValue("simulationTime", "Time the traffic stops (s)", params.simulationTime);
+    cmd.AddValue("warmupTime", "Time the sinks and sources start (s)", params.warmupTime);
+    cmd.AddValue("offeredLoad", "offered load per station (Mb/s, or \"full\" for a full-buffer source)", params.offeredLoad);
+    cmd.AddValue("queueDepth", "With offeredLoad=full, MAC queue depth to keep (0: up to its MaxSize)", params.queueDepth);
+    cmd.AddValue("BE", "transmission of BK traffic", params.BE);
+    cmd.AddValue("r", "radius", params.r);
+    cmd.AddValue("nSTA", "number of stations", params.nSTA);
+    cmd.AddValue("nSTALegacy", "number of stations Legacy", params.nSTALegacy);
+    cmd.AddValue("nAP", "number of BSSs", params.nAP);
+    cmd.AddValue("layout", "AP layout: line, grid, hex or random (d1 apart)", params.layout);
+    cmd.AddValue("staPlacement", "Stations at d2 from their AP (fixed) or uniform in a disc of radius d2 (disc)", params.staPlacement);
+    cmd.AddValue("staCounts", "AX stations per BSS \"a,b,c\" (overrides nSTA)", params.staCounts);
+    cmd.AddValue("staCountsLegacy", "Legacy stations per BSS \"a,b,c\" (overrides nSTALegacy)", params.staCountsLegacy);
+    cmd.AddValue("reverseBss", "Place BSS i where BSS nAP-1-i would be (scenario 2 of the wall setup)", params.reverseBss);
+    cmd.AddValue("lossModels", "Propagation loss models chained on the channel, \"ns3::A+ns3::B\"", params.lossModels);
+    cmd.AddValue("walls", "Concrete walls \"xMin:xMax:yMin:yMax:zMin:zMax;...\" (m)", params.walls);
+    cmd.AddValue("midWall", "Wall \"thickness:length:height\" (m) halfway between neighbouring APs of the line layout", params.midWall);
+    cmd.AddValue("rtsCts", "enable/disable RTS CTS", params.rtsCts);
+    cmd.AddValue("phy", "PHY and channel models: yans, spectrum, or both to run a single point on each and compare their cost", params.phy);
+    cmd.AddValue("linkCache", "Keep the loss and delay of each (static) node pair after its first query", params.linkCache);
+    cmd.AddValue("cull", "Deliver each frame only to the PHYs its transmitter can reach (needs linkCache)", params.cull);
+    cmd.AddValue("cullFloor", "Energy floor (dBm) below which a receiver cannot sense a transmitter", params.cullFloor);
+    cmd.AddValue("cullMargin", "Margin (dB) under cullFloor kept for aggregate interference", params.cullMargin);
+    cmd.AddValue("stopRelError", "Stop early once every BSS's 95% CI half-width is below this fraction of its mean throughput (0: run for duration, which stays the maximum)", params.stopRelError);
+    cmd.AddValue("stopBatch", "Batch length (s) of the batch means behind stopRelError", params.stopBatch);
+    cmd.AddValue("stopMinBatches", "Batches to collect before stopRelError may stop the run", params.stopMinBatches);
+    cmd.AddValue("flowMonitor", "Collect the results with FlowMonitor on every node (slower, for cross-checking)", params.flowMonitor);
+    cmd.AddValue("l2Traffic", "Send over packet sockets on the Wi-Fi devices, without IP/UDP/ARP (same frame sizes and statistics)", params.l2Traffic);
+    cmd.AddValue("sampleFile", "Append per-interval throughput of every BSS and station to this file", params.sampleFile);
+    cmd.AddValue("sampleInterval", "Sampling interval of sampleFile (s)", params.sampleInterval);
+    cmd.AddValue("profile", "Count and time the executed events per source", params.profile);
+    cmd.AddValue("profileFile", "JSON lines file the event profile of every run is appended to", params.profileFile);
+    cmd.AddValue("rngRun", "Run number to set for RNG (first run number in a sweep)", params.rngRun);
+    cmd.AddValue("sweepD1", "Sweep d1 over \"a,b,c\" or \"start:stop:step\"", sweepD1);
+    cmd.AddValue("sweepD2", "Sweep d2 over \"a,b,c\" or \"start:stop:step\"", sweepD2);
+    cmd.AddValue("sweepObssPdThreshold", "Sweep obssPdThreshold over \"a,b,c\" or \"start:stop:step\"", sweepObssPdThreshold);
+    cmd.AddValue("sweepEnableObssPd", "Sweep enableObssPd over e.g. \"1,0\"", sweepEnableObssPd);
+    cmd.AddValue("sweepRuns", "Number of runs per sweep point (rngRun, rngRun+1, ...)", sweepRuns);
+    cmd.AddValue("sweepFile", "Results table written in sweep mode", sweepFile);
+    cmd.AddValue("drops", "Monte Carlo: run this many random station drops (staPlacement=disc, rngRun, rngRun+1, ...) and report the throughput distribution", drops);
+    cmd.AddValue("dropsFile", "Per-drop results table written with drops", dropsFile);
+    cmd.AddValue("variants", "Run setup and warmup once, then fork one measurement per combination of e.g. \"obssPdThreshold=-82,-72;offeredLoad=50,100\"", variantSpec);
+    cmd.AddValue("checkpoint", "In sweeps, run the sweepObssPdThreshold values of a point as variants forked after one warmup", params.checkpoint);
+    cmd.AddValue("forkJobs", "Variant children to run at the same time", params.forkJobs);
+    cmd.AddValue("resultsFile", "Write per-flow and per-BSS results of every run to this file", resultsFile);
+    cmd.AddValue("resultsFormat", "Format of resultsFile: csv, jsonl or bin", resultsFormat);
+    cmd.AddValue("printParameters", "Print the resolved parameters of the run and the files it would write besides resultsFile, then exit", printParameters);
+    // the scenario file's lines go first, so the command line overrides them
+    cmd.Parse(ExpandScenarioArguments(argc, argv, params.scenario));
+
+    bool sweep = !sweepD1.empty() || !sweepD2.empty() || !sweepObssPdThreshold.empty() || !sweepEnableObssPd.empty() ||
+                 sweepRuns > 1;
+    if (printParameters)
+    {
+        for (const auto &p : ResolvedParameters(params))
+        {
+            std::cout << p.first << '=' << p.second << '\n';
+        }
+        // runs with other outputs than the one results record are not cached
+        std::vector<std::string> outputs;
+        if (!params.sampleFile.empty())
+            outputs.push_back("sampleFile");
+        if (params.profile)
+            outputs.push_back("profileFile");
+        if (drops > 0)
+            outputs.push_back("dropsFile");
+        if (!variantSpec.empty())
+            outputs.push_back("variants");
+        if (sweep)
+            outputs.push_back("sweepFile");
+        std::cout << "outputs=";
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            std::cout << (i ? "," : "") << outputs[i];
+        }
+        std::cout << std::endl;
+        return 0;
+    }
+
+    std::unique_ptr<ResultsSink> sink;
+    if (!resultsFile.empty())
+    {
+        sink = CreateResultsSink(resultsFormat, resultsFile);
+    }
+
+    // one run per backend, each in a child of its own so that its peak RSS is its own
+    if (params.phy == "both")
+    {
+        NS_ABORT_MSG_IF(!variantSpec.empty() || drops > 0 || !sweepD1.empty() || !sweepD2.empty() || !sweepObssPdThreshold.empty() ||
+                            !sweepEnableObssPd.empty() || sweepRuns > 1,
+                        "phy=both compares a single run, sweep with sweep_runner.py --param phy=yans,spectrum");
+        std::vector<SimulationParameters> backends(2, params);
+        backends[0].phy = "yans";
+        backends[1].phy = "spectrum";
+        std::cout.flush();
+        std::vector<SimulationResults> results = ForkVariants(2, 1, [&](uint32_t b) {
+            return RunSimulation(backends[b]);
+        });
+        for (size_t b = 0; b < backends.size(); b++)
+        {
+            std::cout << "PHY backend " << backends[b].phy << '\n';
+            PrintResults(backends[b], results[b]);
+            if (sink)
+            {
+                sink->Write(DescribeParameters(backends[b]), results[b]);
+            }
+        }
+        PrintBackendComparison(backends, results);
+        return 0;
+    }
+
+    if (drops > 0)
+    {
+        NS_ABORT_MSG_IF(!variantSpec.empty() || !sweepD1.empty() || !sweepD2.empty() || !sweepObssPdThreshold.empty() ||
+                            !sweepEnableObssPd.empty() || sweepRuns > 1,
+                        "drops run one point, sweep the drops of several with sweep_runner.py --param staPlacement=disc");
+        RunDrops(params, drops, dropsFile, sink.get());
+        return 0;
+    }
+
+    if (!variantSpec.empty())
+    {
+        std::vector<SimulationParameters> variants = BuildVariants(params, variantSpec);
+        std::vector<SimulationResults> results = RunScenario(params, variants);
+        for (size_t v = 0; v < variants.size(); v++)
+        {
+            std::cout << "Variant obssPdThreshold=" << variants[v].obssPdThreshold << " offeredLoad=" << variants[v].offeredLoad
+                      << " stopRelError=" << variants[v].stopRelError << '\n';
+            PrintResults(variants[v], results[v]);
+            if (sink)
+            {
+                sink->Write(DescribeParameters(variants[v]), results[v]);
+            }
+        }
+        return 0;
+    }
+
+    if (!sweep)
+    {
+        SimulationResults results = RunSimulation(params);
+        PrintResults(params, results);
+        if (sink)
+        {
+            sink->Write(DescribeParameters(params), results);
+        }
+        return 0;
+    }
+
+    RunSweep(params, sweepD1, sweepD2, sweepObssPdThreshold, sweepEnableObssPd, sweepRuns, sweepFile, sink.get());
 
     return 0;
 }
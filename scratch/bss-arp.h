@@ -0,0 +1,67 @@
+/*
+ * Static ARP for the BSS scenarios.
+ *
+ * Nothing in these scenarios ever has to resolve an address at run time, so
+ * every IPv4 interface gets a permanent entry for each address of its own
+ * subnet up front. One ArpCache is shared per subnet (BSS i: 192.168.i.0/24),
+ * filled in the same single pass over the nodes that attaches it.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_ARP_H
+#define BSS_ARP_H
+
+#include "ns3/abort.h"
+#include "ns3/arp-cache.h"
+#include "ns3/assert.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/loopback-net-device.h"
+#include "ns3/node-container.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+/*
+ * Fill one permanent-entry ArpCache per subnet and attach it to every
+ * interface in that subnet. Call after the addresses are assigned. Returns
+ * the number of caches.
+ */
+inline uint32_t
+InstallStaticArp(const ns3::NodeContainer &nodes)
+{
+    std::unordered_map<uint32_t, ns3::Ptr<ns3::ArpCache>> caches;
+    for (auto n = nodes.Begin(); n != nodes.End(); ++n)
+    {
+        ns3::Ptr<ns3::Ipv4L3Protocol> ip = (*n)->GetObject<ns3::Ipv4L3Protocol>();
+        NS_ABORT_MSG_IF(!ip, "Node " << (*n)->GetId() << " has no IPv4 stack");
+        for (uint32_t i = 0; i < ip->GetNInterfaces(); i++)
+        {
+            ns3::Ptr<ns3::Ipv4Interface> iface = ip->GetInterface(i);
+            ns3::Ptr<ns3::NetDevice> device = iface->GetDevice();
+            if (ns3::DynamicCast<ns3::LoopbackNetDevice>(device))
+            {
+                continue;
+            }
+            for (uint32_t k = 0; k < iface->GetNAddresses(); k++)
+            {
+                ns3::Ipv4InterfaceAddress address = iface->GetAddress(k);
+                uint32_t subnet = address.GetLocal().CombineMask(address.GetMask()).Get();
+                ns3::Ptr<ns3::ArpCache> &cache = caches[subnet];
+                if (!cache)
+                {
+                    cache = ns3::CreateObject<ns3::ArpCache>();
+                }
+                ns3::ArpCache::Entry *entry = cache->Add(address.GetLocal());
+                entry->SetMacAddress(device->GetAddress());
+                entry->MarkPermanent();
+                iface->SetArpCache(cache);
+            }
+        }
+    }
+    return caches.size();
+}
+
+#endif /* BSS_ARP_H */
@@ -0,0 +1,559 @@
+/*
+ * Channel-side helpers for the BSS scenarios.
+ *
+ * All nodes of these scenarios sit still, so the loss and delay between any
+ * two of them never change. StaticLinkTable evaluates the channel's own
+ * propagation models once per node pair after mobility is installed, and the
+ * two Cached* models answer the channel from that table instead of redoing
+ * the Friis / buildings math for every receiver of every PPDU. For the
+ * buildings models that is the indoor/outdoor state of both ends and the
+ * building geometry, looked up once per pair at setup instead of per frame.
+ * Models that draw a new value on every call (fading) cannot be tabled;
+ * SplitStaticLoss() cuts them off the chain and they keep running behind
+ * the cached part.
+ *
+ * ReachTable builds on the same table to keep every frame away from the
+ * receivers that could never sense it: CullYansChannel on Yans and
+ * ReachTransmitFilter on a spectrum channel.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_CHANNEL_H
+#define BSS_CHANNEL_H
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/mobility-model.h"
+#include "ns3/net-device.h"
+#include "ns3/node-container.h"
+#include "ns3/pointer.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/spectrum-channel.h"
+#include "ns3/spectrum-phy.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/spectrum-transmit-filter.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Loss models that draw a new value on every call. Everything else in ns-3
+ * gives the same loss for two nodes that stay put; the buildings models
+ * draw their shadowing once per pair and keep it.
+ */
+inline bool
+IsPerCallLossModel(ns3::Ptr<ns3::PropagationLossModel> model)
+{
+    std::string name = model->GetInstanceTypeId().GetName();
+    return name == "ns3::RandomPropagationLossModel" || name == "ns3::NakagamiPropagationLossModel" ||
+           name == "ns3::JakesPropagationLossModel";
+}
+
+/*
+ * Cut the chain starting at `head` before its first per-call model and
+ * return that rest (null if there is none). `head` becomes null when the
+ * chain starts with a per-call model, i.e. there is nothing to table.
+ */
+inline ns3::Ptr<ns3::PropagationLossModel>
+SplitStaticLoss(ns3::Ptr<ns3::PropagationLossModel> &head)
+{
+    if (IsPerCallLossModel(head))
+    {
+        ns3::Ptr<ns3::PropagationLossModel> rest = head;
+        head = nullptr;
+        return rest;
+    }
+    ns3::Ptr<ns3::PropagationLossModel> last = head;
+    while (last->GetNext() && !IsPerCallLossModel(last->GetNext()))
+    {
+        last = last->GetNext();
+    }
+    ns3::Ptr<ns3::PropagationLossModel> rest = last->GetNext();
+    last->SetNext(nullptr);
+    return rest;
+}
+
+/*
+ * Loss (dB) and delay per ordered pair of a fixed set of nodes, evaluated
+ * on the pair's first query and kept from then on. Nothing is computed up
+ * front and only the pairs the channel actually asks for are stored, so a
+ * large topology whose frames are culled to their neighbourhood does not pay
+ * for the N x N pairs that never exchange a frame. The first query of a pair
+ * comes in the same order as without the table, so models that draw a value
+ * once per pair (buildings shadowing) draw the same ones. A CourseChange on
+ * a node drops that node's pairs, so the table stays exact if something does
+ * move. Only meant for deterministic loss models: a random per-call
+ * component would be frozen at its first query. Without a loss model (a
+ * chain of fading models only) the loss is 0 dB.
+ */
+class StaticLinkTable : public ns3::SimpleRefCount<StaticLinkTable>
+{
+  public:
+    StaticLinkTable(ns3::Ptr<ns3::PropagationLossModel> loss,
+                    ns3::Ptr<ns3::PropagationDelayModel> delay,
+                    const ns3::NodeContainer &nodes)
+        : m_lossModel(loss),
+          m_delayModel(delay)
+    {
+        for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+        {
+            ns3::Ptr<ns3::MobilityModel> mobility = (*i)->GetObject<ns3::MobilityModel>();
+            NS_ABORT_MSG_IF(!mobility, "StaticLinkTable needs mobility installed on node " << (*i)->GetId());
+            if (m_index.emplace(ns3::PeekPointer(mobility), m_mobility.size()).second)
+            {
+                m_mobility.push_back(mobility);
+            }
+        }
+        m_n = m_mobility.size();
+        for (uint32_t i = 0; i < m_n; i++)
+        {
+            m_mobility[i]->TraceConnectWithoutContext(
+                "CourseChange",
+                ns3::MakeCallback(&StaticLinkTable::CourseChanged, this));
+        }
+    }
+
+    /* true and the table indices of a and b if both are in the table */
+    bool Find(const ns3::MobilityModel *a, const ns3::MobilityModel *b, uint32_t &ia, uint32_t &ib) const
+    {
+        auto i = m_index.find(a);
+        if (i == m_index.end())
+        {
+            return false;
+        }
+        auto j = m_index.find(b);
+        if (j == m_index.end())
+        {
+            return false;
+        }
+        ia = i->second;
+        ib = j->second;
+        return true;
+    }
+
+    double GetLoss(uint32_t i, uint32_t j) const
+    {
+        return Get(i, j).loss;
+    }
+
+    ns3::Time GetDelay(uint32_t i, uint32_t j) const
+    {
+        return Get(i, j).delay;
+    }
+
+    /* loss of a pair, without storing it if it is not in the table yet */
+    double PeekLoss(uint32_t i, uint32_t j) const
+    {
+        auto it = m_links.find(uint64_t(i) * m_n + j);
+        return it != m_links.end() ? it->second.loss : EvaluateLoss(i, j);
+    }
+
+    uint32_t GetN() const
+    {
+        return m_n;
+    }
+
+    ns3::Ptr<ns3::MobilityModel> GetMobility(uint32_t i) const
+    {
+        return m_mobility[i];
+    }
+
+    ns3::Ptr<ns3::PropagationLossModel> GetLossModel() const
+    {
+        return m_lossModel;
+    }
+
+    ns3::Ptr<ns3::PropagationDelayModel> GetDelayModel() const
+    {
+        return m_delayModel;
+    }
+
+  private:
+    struct Link
+    {
+        double loss;
+        ns3::Time delay;
+    };
+
+    /* transmitter i -> receiver j from the wrapped models */
+    double EvaluateLoss(uint32_t i, uint32_t j) const
+    {
+        // the loss of the models we wrap does not depend on the tx power
+        return i != j && m_lossModel ? -m_lossModel->CalcRxPower(0.0, m_mobility[i], m_mobility[j]) : 0.0;
+    }
+
+    Link Evaluate(uint32_t i, uint32_t j) const
+    {
+        return {EvaluateLoss(i, j), i != j ? m_delayModel->GetDelay(m_mobility[i], m_mobility[j]) : ns3::Seconds(0)};
+    }
+
+    const Link &Get(uint32_t i, uint32_t j) const
+    {
+        uint64_t key = uint64_t(i) * m_n + j;
+        auto it = m_links.find(key);
+        if (it == m_links.end())
+        {
+            it = m_links.emplace(key, Evaluate(i, j)).first;
+        }
+        return it->second;
+    }
+
+    /* forget every pair of the node that moved, they are evaluated again on their next query */
+    void CourseChanged(ns3::Ptr<const ns3::MobilityModel> mobility)
+    {
+        auto found = m_index.find(ns3::PeekPointer(mobility));
+        if (found == m_index.end())
+        {
+            return;
+        }
+        uint32_t i = found->second;
+        for (auto it = m_links.begin(); it != m_links.end();)
+        {
+            if (it->first / m_n == i || it->first % m_n == i)
+            {
+                it = m_links.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    ns3::Ptr<ns3::PropagationLossModel> m_lossModel;
+    ns3::Ptr<ns3::PropagationDelayModel> m_delayModel;
+    std::vector<ns3::Ptr<ns3::MobilityModel>> m_mobility;
+    std::unordered_map<const ns3::MobilityModel *, uint32_t> m_index;
+    uint32_t m_n;
+    mutable std::unordered_map<uint64_t, Link> m_links; // transmitter * m_n + receiver -> link, filled by Get()
+};
+
+/*
+ * loss from a StaticLinkTable; pairs outside the table go to the wrapped
+ * model. Per-call models split off the chain are set as its next model.
+ */
+class CachedPropagationLossModel : public ns3::PropagationLossModel
+{
+  public:
+    static ns3::TypeId GetTypeId()
+    {
+        static ns3::TypeId tid = ns3::TypeId("CachedPropagationLossModel")
+                                     .SetParent<ns3::PropagationLossModel>()
+                                     .SetGroupName("Propagation");
+        return tid;
+    }
+
+    void SetTable(ns3::Ptr<StaticLinkTable> table)
+    {
+        m_table = table;
+    }
+
+    ns3::Ptr<StaticLinkTable> GetTable() const
+    {
+        return m_table;
+    }
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         ns3::Ptr<ns3::MobilityModel> a,
+                         ns3::Ptr<ns3::MobilityModel> b) const override
+    {
+        uint32_t i;
+        uint32_t j;
+        if (m_table->Find(ns3::PeekPointer(a), ns3::PeekPointer(b), i, j))
+        {
+            return txPowerDbm - m_table->GetLoss(i, j);
+        }
+        ns3::Ptr<ns3::PropagationLossModel> model = m_table->GetLossModel();
+        return model ? model->CalcRxPower(txPowerDbm, a, b) : txPowerDbm;
+    }
+
+    int64_t DoAssignStreams(int64_t stream) override
+    {
+        ns3::Ptr<ns3::PropagationLossModel> model = m_table->GetLossModel();
+        return model ? model->AssignStreams(stream) : 0;
+    }
+
+    ns3::Ptr<StaticLinkTable> m_table;
+};
+
+/* delay from a StaticLinkTable; pairs outside the table go to the wrapped model */
+class CachedPropagationDelayModel : public ns3::PropagationDelayModel
+{
+  public:
+    static ns3::TypeId GetTypeId()
+    {
+        static ns3::TypeId tid = ns3::TypeId("CachedPropagationDelayModel")
+                                     .SetParent<ns3::PropagationDelayModel>()
+                                     .SetGroupName("Propagation");
+        return tid;
+    }
+
+    void SetTable(ns3::Ptr<StaticLinkTable> table)
+    {
+        m_table = table;
+    }
+
+    ns3::Time GetDelay(ns3::Ptr<ns3::MobilityModel> a, ns3::Ptr<ns3::MobilityModel> b) const override
+    {
+        uint32_t i;
+        uint32_t j;
+        if (m_table->Find(ns3::PeekPointer(a), ns3::PeekPointer(b), i, j))
+        {
+            return m_table->GetDelay(i, j);
+        }
+        return m_table->GetDelayModel()->GetDelay(a, b);
+    }
+
+  private:
+    int64_t DoAssignStreams(int64_t stream) override
+    {
+        return m_table->GetDelayModel()->AssignStreams(stream);
+    }
+
+    ns3::Ptr<StaticLinkTable> m_table;
+};
+
+/*
+ * Replace the loss and delay models of `channel` with table lookups over
+ * `nodes`, per-call models of the loss chain left running behind them.
+ * Call it once after mobility (and BuildingsHelper) is installed.
+ */
+inline ns3::Ptr<StaticLinkTable>
+InstallStaticLinkCache(ns3::Ptr<ns3::YansWifiChannel> channel, const ns3::NodeContainer &nodes)
+{
+    ns3::PointerValue loss;
+    ns3::PointerValue delay;
+    channel->GetAttribute("PropagationLossModel", loss);
+    channel->GetAttribute("PropagationDelayModel", delay);
+    NS_ABORT_MSG_IF(!loss.Get<ns3::PropagationLossModel>() || !delay.Get<ns3::PropagationDelayModel>(),
+                    "Channel needs its loss and delay models before the link cache is built");
+
+    ns3::Ptr<ns3::PropagationLossModel> head = loss.Get<ns3::PropagationLossModel>();
+    ns3::Ptr<ns3::PropagationLossModel> rest = SplitStaticLoss(head);
+    ns3::Ptr<StaticLinkTable> table =
+        ns3::Create<StaticLinkTable>(head, delay.Get<ns3::PropagationDelayModel>(), nodes);
+    ns3::Ptr<CachedPropagationLossModel> cachedLoss = ns3::CreateObject<CachedPropagationLossModel>();
+    cachedLoss->SetTable(table);
+    cachedLoss->SetNext(rest);
+    ns3::Ptr<CachedPropagationDelayModel> cachedDelay = ns3::CreateObject<CachedPropagationDelayModel>();
+    cachedDelay->SetTable(table);
+    channel->SetPropagationLossModel(cachedLoss);
+    channel->SetPropagationDelayModel(cachedDelay);
+    return table;
+}
+
+/*
+ * The same for a spectrum channel. Its loss models can only be added to,
+ * not replaced, so `loss` and `delay` are handed over here instead of being
+ * set on the channel first.
+ */
+inline ns3::Ptr<StaticLinkTable>
+InstallStaticLinkCache(ns3::Ptr<ns3::SpectrumChannel> channel,
+                       ns3::Ptr<ns3::PropagationLossModel> loss,
+                       ns3::Ptr<ns3::PropagationDelayModel> delay,
+                       const ns3::NodeContainer &nodes)
+{
+    ns3::Ptr<ns3::PropagationLossModel> rest = SplitStaticLoss(loss);
+    ns3::Ptr<StaticLinkTable> table = ns3::Create<StaticLinkTable>(loss, delay, nodes);
+    ns3::Ptr<CachedPropagationLossModel> cachedLoss = ns3::CreateObject<CachedPropagationLossModel>();
+    cachedLoss->SetTable(table);
+    cachedLoss->SetNext(rest);
+    ns3::Ptr<CachedPropagationDelayModel> cachedDelay = ns3::CreateObject<CachedPropagationDelayModel>();
+    cachedDelay->SetTable(table);
+    channel->AddPropagationLossModel(cachedLoss);
+    channel->SetPropagationDelayModel(cachedDelay);
+    return table;
+}
+
+/*
+ * Which wifi PHYs can sense which. Receiver j is in the neighbour set of
+ * transmitter i when the strongest PPDU i can send (TxPowerEnd plus both
+ * antenna gains, minus the table loss) arrives at or above `floorDbm`.
+ * Yans drops anything under RxSensitivity on arrival, so a floor at or below
+ * it (minus a margin for aggregate interference) does not change what the
+ * PHYs see. The spectrum PHYs add such frames to their interference, so
+ * there the margin is what keeps the culled energy negligible. Built once:
+ * tx power or position changes are not tracked. Fading behind the table is
+ * not in it either, the margin has to cover it. Building it evaluates every
+ * pair once (PeekLoss, nothing is stored in the link table) and keeps one
+ * bit per pair plus the neighbour lists.
+ */
+class ReachTable : public ns3::SimpleRefCount<ReachTable>
+{
+  public:
+    ReachTable(ns3::Ptr<StaticLinkTable> links, const ns3::NodeContainer &nodes, double floorDbm)
+    {
+        std::vector<uint32_t> link;
+        for (auto n = nodes.Begin(); n != nodes.End(); ++n)
+        {
+            ns3::Ptr<ns3::MobilityModel> mobility = (*n)->GetObject<ns3::MobilityModel>();
+            for (uint32_t d = 0; d < (*n)->GetNDevices(); d++)
+            {
+                ns3::Ptr<ns3::WifiNetDevice> device = ns3::DynamicCast<ns3::WifiNetDevice>((*n)->GetDevice(d));
+                if (!device)
+                {
+                    continue;
+                }
+                uint32_t i;
+                uint32_t j;
+                NS_ABORT_MSG_IF(!links->Find(ns3::PeekPointer(mobility), ns3::PeekPointer(mobility), i, j),
+                                "Node " << (*n)->GetId() << " is not in the link table");
+                m_index.emplace(ns3::PeekPointer(device), m_phys.size());
+                m_phys.push_back(device->GetPhy());
+                link.push_back(i);
+            }
+        }
+        m_n = m_phys.size();
+        m_reach.assign(m_n * m_n, false);
+        m_neighbors.resize(m_n);
+        for (uint32_t i = 0; i < m_n; i++)
+        {
+            double txDbm = m_phys[i]->GetTxPowerEnd() + m_phys[i]->GetTxGain();
+            for (uint32_t j = 0; j < m_n; j++)
+            {
+                if (i != j && txDbm + m_phys[j]->GetRxGain() - links->PeekLoss(link[i], link[j]) >= floorDbm)
+                {
+                    m_reach[i * m_n + j] = true;
+                    m_neighbors[i].push_back(j);
+                }
+            }
+        }
+    }
+
+    /* true and the index of the PHY of `device` if it is in the table */
+    bool Find(const ns3::NetDevice *device, uint32_t &i) const
+    {
+        auto it = m_index.find(device);
+        if (it == m_index.end())
+        {
+            return false;
+        }
+        i = it->second;
+        return true;
+    }
+
+    bool CanReach(uint32_t tx, uint32_t rx) const
+    {
+        return m_reach[tx * m_n + rx];
+    }
+
+    const std::vector<uint32_t> &GetNeighbors(uint32_t tx) const
+    {
+        return m_neighbors[tx];
+    }
+
+    uint32_t GetN() const
+    {
+        return m_n;
+    }
+
+    ns3::Ptr<ns3::WifiPhy> GetPhy(uint32_t i) const
+    {
+        return m_phys[i];
+    }
+
+    /* average neighbour set size, i.e. receivers per frame with per-transmitter culling */
+    double GetMeanNeighbors() const
+    {
+        double sum = 0;
+        for (const auto &n : m_neighbors)
+        {
+            sum += n.size();
+        }
+        return m_n ? sum / m_n : 0.0;
+    }
+
+  private:
+    std::vector<ns3::Ptr<ns3::WifiPhy>> m_phys;
+    std::unordered_map<const ns3::NetDevice *, uint32_t> m_index; // by Wi-Fi device
+    uint32_t m_n;
+    std::vector<bool> m_reach; // m_n * m_n, row = transmitter
+    std::vector<std::vector<uint32_t>> m_neighbors;
+};
+
+/*
+ * Per-frame culling on Yans. YansWifiChannel::Send is not virtual, but it
+ * only walks the PHY list of the channel the sender is attached to and
+ * schedules the reception on each of them. So every transmitter gets a
+ * YansWifiChannel of its own, with the same (cached) models, listing itself
+ * and its neighbour set: each frame then fans out to exactly the receivers
+ * in its transmitter's reach, whatever the layout. The shared channel the
+ * PHYs came from keeps its list (it has no Remove) but sends nothing any
+ * more.
+ */
+inline void
+CullYansChannel(ns3::Ptr<ReachTable> reach)
+{
+    for (uint32_t i = 0; i < reach->GetN(); i++)
+    {
+        ns3::Ptr<ns3::YansWifiPhy> phy = ns3::DynamicCast<ns3::YansWifiPhy>(reach->GetPhy(i));
+        NS_ABORT_MSG_IF(!phy, "CullYansChannel needs Yans PHYs");
+        // same models as the channel the PHY comes from
+        ns3::Ptr<ns3::YansWifiChannel> old = ns3::DynamicCast<ns3::YansWifiChannel>(phy->GetChannel());
+        ns3::PointerValue loss;
+        ns3::PointerValue delay;
+        old->GetAttribute("PropagationLossModel", loss);
+        old->GetAttribute("PropagationDelayModel", delay);
+        ns3::Ptr<ns3::YansWifiChannel> channel = ns3::CreateObject<ns3::YansWifiChannel>();
+        channel->SetPropagationLossModel(loss.Get<ns3::PropagationLossModel>());
+        channel->SetPropagationDelayModel(delay.Get<ns3::PropagationDelayModel>());
+        phy->SetChannel(channel); // lists the PHY itself, Send skips the sender
+        for (uint32_t j : reach->GetNeighbors(i))
+        {
+            channel->Add(ns3::DynamicCast<ns3::YansWifiPhy>(reach->GetPhy(j)));
+        }
+    }
+}
+
+/*
+ * Per-frame culling on a spectrum channel: the channel asks the filter for
+ * every receiver of every signal before it computes the loss or schedules
+ * anything, and the filter drops the receivers out of the transmitter's
+ * reach. Signals from or to devices outside the table are let through.
+ */
+class ReachTransmitFilter : public ns3::SpectrumTransmitFilter
+{
+  public:
+    static ns3::TypeId GetTypeId()
+    {
+        static ns3::TypeId tid = ns3::TypeId("ReachTransmitFilter")
+                                     .SetParent<ns3::SpectrumTransmitFilter>()
+                                     .SetGroupName("Spectrum");
+        return tid;
+    }
+
+    void SetReachTable(ns3::Ptr<ReachTable> reach)
+    {
+        m_reach = reach;
+    }
+
+  private:
+    bool DoFilter(ns3::Ptr<const ns3::SpectrumSignalParameters> params,
+                  ns3::Ptr<const ns3::SpectrumPhy> receiverPhy) override
+    {
+        uint32_t tx;
+        uint32_t rx;
+        return params->txPhy && m_reach->Find(ns3::PeekPointer(params->txPhy->GetDevice()), tx) &&
+               m_reach->Find(ns3::PeekPointer(receiverPhy->GetDevice()), rx) && !m_reach->CanReach(tx, rx);
+    }
+
+    int64_t DoAssignStreams(int64_t stream) override
+    {
+        return 0;
+    }
+
+    ns3::Ptr<ReachTable> m_reach;
+};
+
+#endif /* BSS_CHANNEL_H */
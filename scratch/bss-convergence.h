@@ -0,0 +1,164 @@
+/*
+ * Stop a run once the per-BSS throughput has settled.
+ *
+ * ConvergenceMonitor counts the bytes every PacketSink receives (Rx trace
+ * into a plain per-BSS counter) and, from its start time on, closes a batch
+ * every batch length. With n batches the estimate of a BSS is the mean batch
+ * throughput and its 95 % confidence interval half-width is
+ * t(n-1) * s / sqrt(n) (batch means: batches long compared with the MAC
+ * dynamics are close to independent). Once the half-width is below
+ * `relError` times the mean for every BSS, it calls Simulator::Stop(); the
+ * caller's Simulator::Stop(duration) stays in place as the maximum.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_CONVERGENCE_H
+#define BSS_CONVERGENCE_H
+
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/* two-sided 95 % quantile of Student's t with df degrees of freedom */
+inline double
+StudentT95(uint32_t df)
+{
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    NS_ABORT_MSG_IF(df == 0, "Need at least two batches");
+    if (df <= 30)
+    {
+        return table[df - 1];
+    }
+    // first Cornish-Fisher term around the normal quantile, within 0.005 from here on
+    const double z = 1.959964;
+    return z + (z * z * z + z) / (4.0 * df);
+}
+
+class ConvergenceMonitor
+{
+  public:
+    ConvergenceMonitor(uint32_t nBss, ns3::Time batch, double relError, uint32_t minBatches = 10)
+        : m_batch(batch),
+          m_relError(relError),
+          m_minBatches(minBatches),
+          m_bytes(nBss, 0),
+          m_sum(nBss, 0.0),
+          m_sumSquares(nBss, 0.0),
+          m_batches(0),
+          m_converged(false)
+    {
+        NS_ABORT_MSG_IF(!batch.IsStrictlyPositive(), "Batch length must be positive");
+        NS_ABORT_MSG_IF(relError <= 0, "Relative error target must be positive");
+        NS_ABORT_MSG_IF(minBatches < 2, "Need at least two batches for a confidence interval");
+    }
+
+    /* count what `sink` receives for BSS `bss` (0-based); before Start() */
+    void AddStation(uint32_t bss, ns3::Ptr<ns3::PacketSink> sink)
+    {
+        NS_ABORT_MSG_IF(bss >= m_bytes.size(),
+                        "Station of BSS " << bss << " added to a monitor of " << m_bytes.size() << " BSSs");
+        sink->TraceConnectWithoutContext("Rx", ns3::MakeBoundCallback(&ConvergenceMonitor::CountRx, &m_bytes[bss]));
+    }
+
+    /* first batch starts at `start` (after the warmup and the source start jitter) */
+    void Start(ns3::Time start)
+    {
+        m_event = ns3::Simulator::Schedule(start - ns3::Simulator::Now(), &ConvergenceMonitor::Open, this);
+    }
+
+    bool HasConverged() const
+    {
+        return m_converged;
+    }
+
+    uint32_t GetNBatches() const
+    {
+        return m_batches;
+    }
+
+    /* largest relative half-width over the BSSs after the last batch */
+    double GetRelativeError() const
+    {
+        double worst = 0.0;
+        for (uint32_t b = 0; b < m_sum.size(); b++)
+        {
+            worst = std::max(worst, RelativeError(b));
+        }
+        return worst;
+    }
+
+  private:
+    static void CountRx(uint64_t *bytes, ns3::Ptr<const ns3::Packet> packet, const ns3::Address &from)
+    {
+        *bytes += packet->GetSize();
+    }
+
+    void Open()
+    {
+        m_last = m_bytes;
+        m_event = ns3::Simulator::Schedule(m_batch, &ConvergenceMonitor::Close, this);
+    }
+
+    void Close()
+    {
+        double seconds = m_batch.GetSeconds();
+        for (uint32_t b = 0; b < m_bytes.size(); b++)
+        {
+            double mbps = (m_bytes[b] - m_last[b]) * 8.0 / seconds / 1024 / 1024;
+            m_sum[b] += mbps;
+            m_sumSquares[b] += mbps * mbps;
+        }
+        m_last = m_bytes;
+        m_batches++;
+        if (m_batches >= m_minBatches && GetRelativeError() < m_relError)
+        {
+            m_converged = true;
+            ns3::Simulator::Stop();
+            return;
+        }
+        m_event = ns3::Simulator::Schedule(m_batch, &ConvergenceMonitor::Close, this);
+    }
+
+    /* half-width / mean of BSS b; a BSS that received nothing at all is settled */
+    double RelativeError(uint32_t b) const
+    {
+        if (m_batches < 2)
+        {
+            return INFINITY;
+        }
+        double n = m_batches;
+        double mean = m_sum[b] / n;
+        if (mean <= 0)
+        {
+            return 0.0;
+        }
+        double variance = std::max(0.0, (m_sumSquares[b] - n * mean * mean) / (n - 1));
+        return StudentT95(m_batches - 1) * std::sqrt(variance / n) / mean;
+    }
+
+    ns3::Time m_batch;
+    double m_relError;
+    uint32_t m_minBatches;
+    std::vector<uint64_t> m_bytes; // received so far, per BSS
+    std::vector<uint64_t> m_last;  // m_bytes when the batch opened
+    std::vector<double> m_sum;        // of the batch throughputs, Mb/s
+    std::vector<double> m_sumSquares; // of their squares
+    uint32_t m_batches;
+    bool m_converged;
+    ns3::EventId m_event;
+};
+
+#endif /* BSS_CONVERGENCE_H */
@@ -0,0 +1,145 @@
+/*
+ * Which BSS and station every traffic flow belongs to.
+ *
+ * installTrafficGenerator() registers each flow as it creates it, and the
+ * flow id it gets back indexes everything else: the FlowStatsCollector slots
+ * and the result rows. Going back from a packet's destination address and
+ * port (what FlowMonitor reports) is one hash lookup, so nothing has to be
+ * decoded from port numbers and no BSS count or station count is tied to a
+ * port range.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_FLOWS_H
+#define BSS_FLOWS_H
+
+#include "bss-results.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/qos-utils.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/* what is known about a flow when it is installed */
+struct FlowDescriptor
+{
+    uint32_t bss = 0; // 0-based BSS index
+    uint32_t sta = 0; // station number within the BSS, as printed in the text report
+    bool ax = true;   // 802.11ax station, 802.11a (legacy) otherwise
+    ns3::AcIndex ac = ns3::AC_BE;
+    ns3::Ipv4Address destination; // sink address
+    uint16_t port = 0;            // sink port
+};
+
+class FlowRegistry
+{
+  public:
+    /* returns the flow id, 0, 1, ... in installation order */
+    uint32_t Register(const FlowDescriptor &flow)
+    {
+        uint32_t id = m_flows.size();
+        bool added = m_index.emplace(Key(flow.destination, flow.port), id).second;
+        NS_ABORT_MSG_IF(!added, "Two flows to " << flow.destination << ":" << flow.port);
+        m_flows.push_back(flow);
+        return id;
+    }
+
+    uint32_t GetNFlows() const
+    {
+        return m_flows.size();
+    }
+
+    const FlowDescriptor &Get(uint32_t id) const
+    {
+        NS_ASSERT(id < m_flows.size());
+        return m_flows[id];
+    }
+
+    /* id of the flow to destination:port, -1 if none was registered */
+    int Find(ns3::Ipv4Address destination, uint16_t port) const
+    {
+        auto it = m_index.find(Key(destination, port));
+        return it == m_index.end() ? -1 : static_cast<int>(it->second);
+    }
+
+    /* a result row with the flow's identity filled in and all counters zero */
+    FlowResult MakeResult(uint32_t id) const
+    {
+        const FlowDescriptor &flow = Get(id);
+        FlowResult result;
+        result.flowId = id + 1;
+        result.bss = flow.bss;
+        result.sta = flow.sta;
+        result.port = flow.port;
+        result.ax = flow.ax;
+        result.ac = flow.ac;
+        return result;
+    }
+
+  private:
+    static uint64_t Key(ns3::Ipv4Address destination, uint16_t port)
+    {
+        return (static_cast<uint64_t>(destination.Get()) << 16) | port;
+    }
+
+    std::vector<FlowDescriptor> m_flows;
+    std::unordered_map<uint64_t, uint32_t> m_index; // (address, port) -> id
+};
+
+/*
+ * Match the FlowMonitor flows to the registered ones by destination address
+ * and port. Every registered flow gets a row, in flow id order, also when
+ * none of its packets was seen; unregistered traffic is left out.
+ */
+inline SimulationResults
+CollectFlowMonitorResults(ns3::Ptr<ns3::FlowMonitor> flowMonitor,
+                          ns3::Ptr<ns3::Ipv4FlowClassifier> classifier,
+                          const FlowRegistry &flows,
+                          uint32_t nBss)
+{
+    std::vector<FlowResult> rows;
+    rows.reserve(flows.GetNFlows());
+    for (uint32_t id = 0; id < flows.GetNFlows(); id++)
+    {
+        rows.push_back(flows.MakeResult(id));
+    }
+
+    for (const auto &entry : flowMonitor->GetFlowStats())
+    {
+        ns3::Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(entry.first);
+        int id = flows.Find(t.destinationAddress, t.destinationPort);
+        if (id < 0)
+        {
+            continue;
+        }
+        const ns3::FlowMonitor::FlowStats &stats = entry.second;
+        FlowResult &flow = rows[id];
+        flow.txBytes = stats.txBytes;
+        flow.rxBytes = stats.rxBytes;
+        flow.txPackets = stats.txPackets;
+        flow.rxPackets = stats.rxPackets;
+        flow.lostPackets = stats.lostPackets;
+        flow.delaySum = stats.delaySum.GetSeconds();
+        flow.jitterSum = stats.jitterSum.GetSeconds();
+        flow.timeFirstTxPacket = stats.timeFirstTxPacket.GetSeconds();
+        flow.timeLastRxPacket = stats.timeLastRxPacket.GetSeconds();
+    }
+
+    SimulationResults results;
+    results.bss.resize(nBss);
+    for (FlowResult &flow : rows)
+    {
+        flow.throughput = FlowThroughput(flow.rxBytes, flow.timeFirstTxPacket, flow.timeLastRxPacket);
+        AccumulateFlow(results, flow);
+    }
+    return results;
+}
+
+#endif /* BSS_FLOWS_H */
@@ -0,0 +1,144 @@
+/*
+ * Per-flow statistics taken straight from the traffic applications.
+ *
+ * FlowMonitorHelper::InstallAll() puts probes on the IP stack of every node
+ * and classifies each packet into a five-tuple flow at every hop, only for
+ * the results to be matched back to BSS and station afterwards. The
+ * scenarios register their flows when they install them (bss-flows.h), so
+ * FlowStatsCollector keeps one slot per flow id and the source Tx and sink
+ * RxWithSeqTsSize traces update that slot directly: no classification and no
+ * map lookup per packet. Delay comes from the SeqTsSizeHeader the sources put
+ * in front of the payload (the packets keep their size on air). PacketSink
+ * strips that header before it fires RxWithSeqTsSize, so the received size
+ * is the one the header carries, the size the source sent.
+ *
+ * The counters follow FlowMonitor: bytes include the IPv4 and UDP headers,
+ * jitter is the sum of |delay - previous delay| and a packet counts as lost
+ * when it was sent but had not arrived by the end of the run.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_FLOWSTATS_H
+#define BSS_FLOWSTATS_H
+
+#include "bss-flows.h"
+#include "bss-results.h"
+
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/assert.h"
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet.h"
+#include "ns3/seq-ts-size-header.h"
+#include "ns3/simulator.h"
+
+#include <cstdint>
+#include <vector>
+
+class FlowStatsCollector
+{
+  public:
+    /* headerBytes: added to every packet so the byte counts match FlowMonitor's (IPv4 + UDP) */
+    explicit FlowStatsCollector(const FlowRegistry &flows, uint32_t headerBytes = 28)
+        : m_flows(flows),
+          m_headerBytes(headerBytes)
+    {
+    }
+
+    /* count registered flow `index` from `source` (fires "Tx") to `sink` (with EnableSeqTsSizeHeader) */
+    void AddFlow(uint32_t index, ns3::Ptr<ns3::Application> source, ns3::Ptr<ns3::PacketSink> sink)
+    {
+        NS_ABORT_MSG_IF(index >= m_flows.GetNFlows(), "Flow " << index << " is not registered");
+        if (index >= m_counters.size())
+        {
+            m_counters.resize(index + 1);
+        }
+        bool connected =
+            source->TraceConnectWithoutContext("Tx", ns3::MakeBoundCallback(&FlowStatsCollector::SentPacket, this, index));
+        NS_ABORT_MSG_IF(!connected, "Traffic source " << source->GetInstanceTypeId().GetName() << " has no Tx trace");
+        sink->TraceConnectWithoutContext("RxWithSeqTsSize",
+                                         ns3::MakeBoundCallback(&FlowStatsCollector::ReceivedPacket, this, index));
+    }
+
+    /* per-flow (in flow id order), per-BSS and total results of the run so far */
+    SimulationResults GetResults(uint32_t nBss) const
+    {
+        SimulationResults results;
+        results.bss.resize(nBss);
+        for (uint32_t i = 0; i < m_flows.GetNFlows(); i++)
+        {
+            const Counters &c = i < m_counters.size() ? m_counters[i] : Counters();
+            // both ends count the same bytes per packet, so a flow that lost nothing received what it sent
+            NS_ASSERT_MSG(c.rxPackets != c.txPackets || c.rxBytes == c.txBytes,
+                          "Flow " << i << ": " << c.rxBytes << " bytes received of " << c.txBytes << " sent");
+            FlowResult flow = m_flows.MakeResult(i);
+            flow.txBytes = c.txBytes;
+            flow.rxBytes = c.rxBytes;
+            flow.txPackets = c.txPackets;
+            flow.rxPackets = c.rxPackets;
+            flow.lostPackets = c.txPackets - c.rxPackets;
+            flow.delaySum = c.delaySum.GetSeconds();
+            flow.jitterSum = c.jitterSum.GetSeconds();
+            flow.timeFirstTxPacket = c.timeFirstTxPacket.GetSeconds();
+            flow.timeLastRxPacket = c.timeLastRxPacket.GetSeconds();
+            flow.throughput = FlowThroughput(flow.rxBytes, flow.timeFirstTxPacket, flow.timeLastRxPacket);
+            AccumulateFlow(results, flow);
+        }
+        return results;
+    }
+
+  private:
+    struct Counters
+    {
+        uint64_t txBytes = 0;
+        uint64_t rxBytes = 0;
+        uint32_t txPackets = 0;
+        uint32_t rxPackets = 0;
+        ns3::Time delaySum;
+        ns3::Time jitterSum;
+        ns3::Time lastDelay;
+        ns3::Time timeFirstTxPacket;
+        ns3::Time timeLastRxPacket;
+    };
+
+    static void SentPacket(FlowStatsCollector *collector, uint32_t index, ns3::Ptr<const ns3::Packet> packet)
+    {
+        Counters &c = collector->m_counters[index];
+        if (c.txPackets++ == 0)
+        {
+            c.timeFirstTxPacket = ns3::Simulator::Now();
+        }
+        c.txBytes += packet->GetSize() + collector->m_headerBytes;
+    }
+
+    static void ReceivedPacket(FlowStatsCollector *collector,
+                               uint32_t index,
+                               ns3::Ptr<const ns3::Packet> packet,
+                               const ns3::Address &from,
+                               const ns3::Address &to,
+                               const ns3::SeqTsSizeHeader &header)
+    {
+        Counters &c = collector->m_counters[index];
+        ns3::Time now = ns3::Simulator::Now();
+        ns3::Time delay = now - header.GetTs();
+        if (c.rxPackets++ > 0)
+        {
+            c.jitterSum += ns3::Abs(delay - c.lastDelay);
+        }
+        c.lastDelay = delay;
+        c.delaySum += delay;
+        c.rxBytes += header.GetSize() + collector->m_headerBytes;
+        c.timeLastRxPacket = now;
+    }
+
+    const FlowRegistry &m_flows;
+    uint32_t m_headerBytes;
+    std::vector<Counters> m_counters; // by flow id, updated per packet
+};
+
+#endif /* BSS_FLOWSTATS_H */
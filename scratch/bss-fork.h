@@ -0,0 +1,182 @@
+/*
+ * Run variants of a simulation from a common checkpoint with fork().
+ *
+ * The parent builds the scenario and simulates up to the checkpoint, then
+ * ForkVariants() forks one child per variant. Each child inherits the whole
+ * simulator state copy-on-write, applies its parameter change, runs the
+ * measurement phase and sends its SimulationResults back through a pipe as
+ * raw bytes (parent and child are the same binary). Nothing of ns-3 is
+ * serialized and the setup is paid once for all variants.
+ *
+ * Children leave with _exit(), so buffered output the parent had not written
+ * yet is not written twice; flush what must be kept before forking.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_FORK_H
+#define BSS_FORK_H
+
+#include "bss-results.h"
+
+#include "ns3/abort.h"
+#include "ns3/fatal-error.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+static_assert(std::is_trivially_copyable<FlowResult>::value, "FlowResult is sent through a pipe as raw bytes");
+static_assert(std::is_trivially_copyable<BssResult>::value, "BssResult is sent through a pipe as raw bytes");
+
+/* write all `size` bytes, false if the other end is gone */
+inline bool
+WriteFully(int fd, const void *data, size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+    while (size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+/* read exactly `size` bytes, false on a short read */
+inline bool
+ReadFully(int fd, void *data, size_t size)
+{
+    char *p = static_cast<char *>(data);
+    while (size > 0)
+    {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+/* u64 nFlows, u64 nBss, u64 events, the flows, the BSSs, then the seven totals */
+inline bool
+WriteResults(int fd, const SimulationResults &results)
+{
+    uint64_t counts[3] = {results.flows.size(), results.bss.size(), results.events};
+    double totals[7] = {results.throughputAX,
+                        results.throughputLegacy,
+                        results.totalThroughput,
+                        results.wallTime,
+                        results.simTime,
+                        results.peakRss,
+                        results.setupTime};
+    return WriteFully(fd, counts, sizeof(counts)) &&
+           WriteFully(fd, results.flows.data(), results.flows.size() * sizeof(FlowResult)) &&
+           WriteFully(fd, results.bss.data(), results.bss.size() * sizeof(BssResult)) &&
+           WriteFully(fd, totals, sizeof(totals));
+}
+
+inline bool
+ReadResults(int fd, SimulationResults &results)
+{
+    uint64_t counts[3];
+    double totals[7];
+    if (!ReadFully(fd, counts, sizeof(counts)))
+    {
+        return false;
+    }
+    results.flows.resize(counts[0]);
+    results.bss.resize(counts[1]);
+    if (!ReadFully(fd, results.flows.data(), counts[0] * sizeof(FlowResult)) ||
+        !ReadFully(fd, results.bss.data(), counts[1] * sizeof(BssResult)) || !ReadFully(fd, totals, sizeof(totals)))
+    {
+        return false;
+    }
+    results.throughputAX = totals[0];
+    results.throughputLegacy = totals[1];
+    results.totalThroughput = totals[2];
+    results.wallTime = totals[3];
+    results.simTime = totals[4];
+    results.events = counts[2];
+    results.peakRss = totals[5];
+    results.setupTime = totals[6];
+    return true;
+}
+
+/*
+ * Call variant(i) for i = 0 .. n-1, each in a child forked from the current
+ * state, at most `parallel` children at a time. Returns the results in
+ * variant order; a child that crashed or exited without results is fatal.
+ */
+inline std::vector<SimulationResults>
+ForkVariants(uint32_t n, uint32_t parallel, const std::function<SimulationResults(uint32_t)> &variant)
+{
+    NS_ABORT_MSG_IF(parallel == 0, "Need at least one child at a time");
+    std::vector<SimulationResults> results(n);
+    for (uint32_t first = 0; first < n; first += parallel)
+    {
+        uint32_t last = std::min(n, first + parallel);
+        std::vector<pid_t> children;
+        std::vector<int> pipes;
+        for (uint32_t i = first; i < last; i++)
+        {
+            int fds[2];
+            NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed: " << std::strerror(errno));
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "fork() failed: " << std::strerror(errno));
+            if (pid == 0)
+            {
+                close(fds[0]);
+                for (int fd : pipes)
+                {
+                    close(fd);
+                }
+                bool sent = WriteResults(fds[1], variant(i));
+                close(fds[1]);
+                _exit(sent ? 0 : 1);
+            }
+            close(fds[1]);
+            children.push_back(pid);
+            pipes.push_back(fds[0]);
+        }
+        // a child blocked on a full pipe waits for its turn, the others go on
+        for (uint32_t k = 0; k < children.size(); k++)
+        {
+            bool received = ReadResults(pipes[k], results[first + k]);
+            close(pipes[k]);
+            int status = 0;
+            waitpid(children[k], &status, 0);
+            if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                NS_FATAL_ERROR("Variant " << first + k << " (pid " << children[k] << ") failed, status " << status);
+            }
+        }
+    }
+    return results;
+}
+
+#endif /* BSS_FORK_H */
@@ -0,0 +1,318 @@
+/*
+ * Opt-in event loop profiling for the BSS scenarios.
+ *
+ * ProfilingSimulatorImpl is the default scheduler with every scheduled event
+ * wrapped in a ProfiledEvent, which counts it and times its execution under
+ * the dynamic type of the event. That type names the member function's class
+ * (YansWifiChannel, ChannelAccessManager, OnOffApplication, ...), so the
+ * per-source breakdown costs one hash lookup per Schedule and two clock reads
+ * per event; names are only demangled when the profile is read.
+ *
+ * Select it before the first Simulator call of a run:
+ *
+ *     UseProfilingSimulator();
+ *     ...
+ *     Simulator::Run();
+ *     EventProfile profile = GetEventProfile();
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_PROFILER_H
+#define BSS_PROFILER_H
+
+#include "bss-results.h"
+
+#include "ns3/abort.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/event-impl.h"
+#include "ns3/global-value.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+/* executed events and their cumulative wall time, per event type */
+struct EventSourceStats
+{
+    uint64_t events = 0;
+    uint64_t nanoseconds = 0;
+};
+
+/* runs the wrapped event and charges its wall time to one EventSourceStats */
+class ProfiledEvent : public ns3::EventImpl
+{
+  public:
+    ProfiledEvent(ns3::EventImpl *event, EventSourceStats *stats)
+        : m_event(event),
+          m_stats(stats)
+    {
+    }
+
+    ~ProfiledEvent() override
+    {
+        m_event->Unref();
+    }
+
+  protected:
+    void Notify() override
+    {
+        auto start = std::chrono::steady_clock::now();
+        m_event->Invoke();
+        m_stats->nanoseconds +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        m_stats->events++;
+    }
+
+  private:
+    ns3::EventImpl *m_event; // owned, the simulator only sees this wrapper
+    EventSourceStats *m_stats;
+};
+
+/* one line of the per-source table */
+struct EventSourceProfile
+{
+    std::string source;   // class of the scheduled member function, or the event type
+    std::string category; // PHY, MAC, OnOff, traffic, FlowMonitor, IP or other
+    uint64_t events = 0;
+    double wallTime = 0.0; // seconds inside the events
+};
+
+/* everything the profiler knows after Simulator::Run() */
+struct EventProfile
+{
+    uint64_t events = 0;
+    double runWallTime = 0.0; // seconds in Simulator::Run()
+    double simTime = 0.0;     // simulated seconds reached
+    std::vector<EventSourceProfile> sources;    // by wall time, largest first
+    std::vector<EventSourceProfile> categories; // same, summed per category
+
+    double GetEventsPerSecond() const
+    {
+        return runWallTime > 0 ? events / runWallTime : 0.0;
+    }
+
+    /* simulated seconds per wall clock second */
+    double GetSpeedup() const
+    {
+        return runWallTime > 0 ? simTime / runWallTime : 0.0;
+    }
+
+    void Print(std::ostream &os) const
+    {
+        os << "Event profile" << '\n';
+        os << "  events:\t" << events << '\n';
+        os << "  Run() wall time:\t" << runWallTime << " s" << '\n';
+        os << "  events per second:\t" << GetEventsPerSecond() << '\n';
+        os << "  simulated/wall:\t" << GetSpeedup() << '\n';
+        for (const EventSourceProfile &c : categories)
+        {
+            os << "  " << c.category << ":\t" << c.events << " events\t" << c.wallTime << " s" << '\n';
+        }
+        for (const EventSourceProfile &s : sources)
+        {
+            os << "    " << s.source << " (" << s.category << "):\t" << s.events << " events\t" << s.wallTime
+               << " s" << '\n';
+        }
+        os.flush();
+    }
+
+    /* one JSON object on one line */
+    void WriteJson(std::ostream &os, const RunParameters &params) const
+    {
+        os << "{\"params\":{";
+        for (size_t i = 0; i < params.size(); i++)
+        {
+            os << (i ? "," : "") << JsonQuote(params[i].first) << ':' << JsonQuote(params[i].second);
+        }
+        os << "},\"events\":" << events << ",\"runWallTime\":" << runWallTime << ",\"simTime\":" << simTime
+           << ",\"eventsPerSecond\":" << GetEventsPerSecond() << ",\"simWallRatio\":" << GetSpeedup()
+           << ",\"categories\":[";
+        for (size_t i = 0; i < categories.size(); i++)
+        {
+            os << (i ? "," : "") << "{\"category\":" << JsonQuote(categories[i].category)
+               << ",\"events\":" << categories[i].events << ",\"wallTime\":" << categories[i].wallTime << '}';
+        }
+        os << "],\"sources\":[";
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            os << (i ? "," : "") << "{\"source\":" << JsonQuote(sources[i].source)
+               << ",\"category\":" << JsonQuote(sources[i].category) << ",\"events\":" << sources[i].events
+               << ",\"wallTime\":" << sources[i].wallTime << '}';
+        }
+        os << "]}\n";
+    }
+};
+
+class ProfilingSimulatorImpl : public ns3::DefaultSimulatorImpl
+{
+  public:
+    static ns3::TypeId GetTypeId()
+    {
+        static ns3::TypeId tid = ns3::TypeId("ProfilingSimulatorImpl")
+                                     .SetParent<ns3::DefaultSimulatorImpl>()
+                                     .SetGroupName("Core")
+                                     .AddConstructor<ProfilingSimulatorImpl>();
+        return tid;
+    }
+
+    ns3::EventId Schedule(const ns3::Time &delay, ns3::EventImpl *event) override
+    {
+        return ns3::DefaultSimulatorImpl::Schedule(delay, Wrap(event));
+    }
+
+    void ScheduleWithContext(uint32_t context, const ns3::Time &delay, ns3::EventImpl *event) override
+    {
+        ns3::DefaultSimulatorImpl::ScheduleWithContext(context, delay, Wrap(event));
+    }
+
+    ns3::EventId ScheduleNow(ns3::EventImpl *event) override
+    {
+        return ns3::DefaultSimulatorImpl::ScheduleNow(Wrap(event));
+    }
+
+    void Run() override
+    {
+        auto start = std::chrono::steady_clock::now();
+        ns3::DefaultSimulatorImpl::Run();
+        m_runWallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    EventProfile GetProfile() const
+    {
+        EventProfile profile;
+        profile.runWallTime = m_runWallTime;
+        profile.simTime = Now().GetSeconds();
+        std::map<std::string, EventSourceProfile> sources;
+        for (const auto &entry : m_stats)
+        {
+            if (entry.second.events == 0)
+            {
+                continue;
+            }
+            std::string source = SourceName(entry.first);
+            EventSourceProfile &s = sources[source];
+            s.source = source;
+            s.category = Categorize(source);
+            s.events += entry.second.events;
+            s.wallTime += entry.second.nanoseconds * 1e-9;
+            profile.events += entry.second.events;
+        }
+        std::map<std::string, EventSourceProfile> categories;
+        for (const auto &entry : sources)
+        {
+            profile.sources.push_back(entry.second);
+            EventSourceProfile &c = categories[entry.second.category];
+            c.category = entry.second.category;
+            c.events += entry.second.events;
+            c.wallTime += entry.second.wallTime;
+        }
+        for (const auto &entry : categories)
+        {
+            profile.categories.push_back(entry.second);
+        }
+        auto byWallTime = [](const EventSourceProfile &a, const EventSourceProfile &b) {
+            return a.wallTime > b.wallTime;
+        };
+        std::sort(profile.sources.begin(), profile.sources.end(), byWallTime);
+        std::sort(profile.categories.begin(), profile.categories.end(), byWallTime);
+        return profile;
+    }
+
+  private:
+    ns3::EventImpl *Wrap(ns3::EventImpl *event)
+    {
+        if (dynamic_cast<ProfiledEvent *>(event))
+        {
+            return event;
+        }
+        return new ProfiledEvent(event, &m_stats[std::type_index(typeid(*event))]);
+    }
+
+    /* "void (ns3::YansWifiChannel::*)(...)" inside the event type -> "ns3::YansWifiChannel" */
+    static std::string SourceName(const std::type_index &type)
+    {
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : type.name();
+        std::free(demangled);
+        size_t end = name.find("::*)");
+        if (end == std::string::npos)
+        {
+            return name.size() > 120 ? name.substr(0, 120) + "..." : name;
+        }
+        size_t begin = name.rfind('(', end);
+        return name.substr(begin + 1, end - begin - 1);
+    }
+
+    static std::string Categorize(const std::string &source)
+    {
+        static const std::vector<std::pair<const char *, const char *>> rules = {
+            {"OnOffApplication", "OnOff"},
+            {"FullBufferApplication", "traffic"},
+            {"PacketSink", "traffic"},
+            {"FlowMonitor", "FlowMonitor"},
+            {"FlowProbe", "FlowMonitor"},
+            {"WifiChannel", "PHY"},
+            {"SpectrumChannel", "PHY"},
+            {"Phy", "PHY"},
+            {"InterferenceHelper", "PHY"},
+            {"ChannelAccessManager", "MAC"},
+            {"Txop", "MAC"},
+            {"FrameExchangeManager", "MAC"},
+            {"WifiMac", "MAC"},
+            {"BlockAck", "MAC"},
+            {"WifiRemoteStationManager", "MAC"},
+            {"MacRxMiddle", "MAC"},
+            {"MacTxMiddle", "MAC"},
+            {"Arp", "IP"},
+            {"Ipv4", "IP"},
+            {"Udp", "IP"},
+            {"TrafficControl", "IP"},
+            {"QueueDisc", "IP"},
+        };
+        for (const auto &rule : rules)
+        {
+            if (source.find(rule.first) != std::string::npos)
+            {
+                return rule.second;
+            }
+        }
+        return "other";
+    }
+
+    std::unordered_map<std::type_index, EventSourceStats> m_stats;
+    double m_runWallTime = 0.0;
+};
+
+/* make the next simulator instance (the next run after Simulator::Destroy()) a profiling one */
+inline void
+UseProfilingSimulator()
+{
+    ProfilingSimulatorImpl::GetTypeId();
+    ns3::GlobalValue::Bind("SimulatorImplementationType", ns3::StringValue("ProfilingSimulatorImpl"));
+}
+
+/* profile of the current simulator instance, read before Simulator::Destroy() */
+inline EventProfile
+GetEventProfile()
+{
+    ns3::Ptr<ProfilingSimulatorImpl> impl =
+        ns3::DynamicCast<ProfilingSimulatorImpl>(ns3::Simulator::GetImplementation());
+    NS_ABORT_MSG_IF(!impl, "GetEventProfile() needs UseProfilingSimulator() before the run");
+    return impl->GetProfile();
+}
+
+#endif /* BSS_PROFILER_H */
@@ -0,0 +1,431 @@
+/*
+ * Results of a BSS simulation run and the sinks that write them to disk.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_RESULTS_H
+#define BSS_RESULTS_H
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/nstime.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* statistics of one source -> sink flow */
+struct FlowResult
+{
+    uint32_t flowId = 0;
+    uint32_t bss = 0;  // 0-based BSS index
+    uint32_t sta = 0;  // station number as printed in the text report
+    uint16_t port = 0; // destination port of the flow
+    bool ax = true;    // 802.11ax station, 802.11a (legacy) otherwise
+    uint8_t ac = 0;    // access category (ns3::AcIndex): 0 BE, 1 BK, 2 VI, 3 VO
+    uint64_t txBytes = 0;
+    uint64_t rxBytes = 0;
+    uint32_t txPackets = 0;
+    uint32_t rxPackets = 0;
+    uint32_t lostPackets = 0;
+    double delaySum = 0.0;          // seconds
+    double jitterSum = 0.0;         // seconds
+    double timeFirstTxPacket = 0.0; // seconds
+    double timeLastRxPacket = 0.0;  // seconds
+    double throughput = 0.0;        // Mb/s
+};
+
+/* sum of all flows of one BSS */
+struct BssResult
+{
+    uint64_t txBytes = 0;
+    uint64_t rxBytes = 0;
+    uint64_t txPackets = 0;
+    uint64_t rxPackets = 0;
+    uint64_t lostPackets = 0;
+    double delaySum = 0.0;  // seconds
+    double jitterSum = 0.0; // seconds
+    double throughput = 0.0;       // Mb/s
+    double throughputAX = 0.0;     // Mb/s
+    double throughputLegacy = 0.0; // Mb/s
+};
+
+/* what is left of one run after Simulator::Destroy() */
+struct SimulationResults
+{
+    std::vector<FlowResult> flows;
+    std::vector<BssResult> bss;
+    double throughputAX = 0.0;     // Mb/s
+    double throughputLegacy = 0.0; // Mb/s
+    double totalThroughput = 0.0;  // Mb/s
+    double wallTime = 0.0;         // setupTime + seconds of this run's own measurement phase
+    double simTime = 0.0;          // simulated seconds, less than the duration after an early stop
+    uint64_t events = 0;           // events the simulator executed, setup and warmup included
+    double peakRss = 0.0;          // MiB, peak RSS of the process, 0 if an earlier run in it peaked higher
+    double setupTime = 0.0;        // seconds of wallTime spent building the scenario (and in the shared warmup)
+};
+
+/* name/value pairs of every parameter that defines a run, in command line order */
+typedef std::vector<std::pair<std::string, std::string>> RunParameters;
+
+/* value of a RunParameters entry, printed the way operator<< does */
+template <typename T>
+std::string
+FormatParameter(const T &value)
+{
+    std::ostringstream oss;
+    oss << value;
+    return oss.str();
+}
+
+/* s as a JSON string literal */
+inline std::string
+JsonQuote(const std::string &s)
+{
+    std::string quoted = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/* s as a CSV field (RFC 4180): quoted, with quotes doubled, when it holds a separator, quote or line break */
+inline std::string
+CsvQuote(const std::string &s)
+{
+    if (s.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        return s;
+    }
+    std::string quoted = "\"";
+    for (char c : s)
+    {
+        if (c == '"')
+        {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/* "BE", "BK", "VI" or "VO" for FlowResult::ac */
+inline const char *
+AcName(uint8_t ac)
+{
+    static const char *names[] = {"BE", "BK", "VI", "VO"};
+    return ac < 4 ? names[ac] : "?";
+}
+
+/* Mb/s the way the text report has always computed it (1 Mb = 1024 * 1024 bit) */
+inline double
+FlowThroughput(uint64_t rxBytes, double timeFirstTxPacket, double timeLastRxPacket)
+{
+    double interval = timeLastRxPacket - timeFirstTxPacket;
+    return (rxBytes > 0 && interval > 0) ? rxBytes * 8.0 / interval / 1024 / 1024 : 0;
+}
+
+/* SimulationResults::peakRss for a table cell: empty when the run's own peak is not known */
+inline std::string
+FormatPeakRss(double peakRss)
+{
+    return peakRss > 0 ? FormatParameter(peakRss) : "";
+}
+
+/* add one flow to the per-BSS and total aggregates */
+inline void
+AccumulateFlow(SimulationResults &results, const FlowResult &flow)
+{
+    NS_ASSERT(flow.bss < results.bss.size());
+    BssResult &bss = results.bss[flow.bss];
+    bss.txBytes += flow.txBytes;
+    bss.rxBytes += flow.rxBytes;
+    bss.txPackets += flow.txPackets;
+    bss.rxPackets += flow.rxPackets;
+    bss.lostPackets += flow.lostPackets;
+    bss.delaySum += flow.delaySum;
+    bss.jitterSum += flow.jitterSum;
+    bss.throughput += flow.throughput;
+    (flow.ax ? bss.throughputAX : bss.throughputLegacy) += flow.throughput;
+    (flow.ax ? results.throughputAX : results.throughputLegacy) += flow.throughput;
+    results.totalThroughput += flow.throughput;
+    results.flows.push_back(flow);
+}
+
+/*
+ * Base of the result writers. The stream gets a large buffer of its own and
+ * records end with '\n', so nothing is flushed until the buffer is full or
+ * the sink is closed.
+ */
+class ResultsSink
+{
+  public:
+    ResultsSink(const std::string &fileName, bool binary)
+        : m_buffer(1 << 20),
+          m_runs(0)
+    {
+        m_out.rdbuf()->pubsetbuf(m_buffer.data(), m_buffer.size());
+        m_out.open(fileName, binary ? std::ios::out | std::ios::binary : std::ios::out);
+        if (!m_out)
+        {
+            NS_FATAL_ERROR("Cannot open results file " << fileName);
+        }
+    }
+
+    virtual ~ResultsSink() = default;
+
+    /* append one run */
+    void Write(const RunParameters &params, const SimulationResults &results)
+    {
+        DoWrite(params, results);
+        m_runs++;
+    }
+
+    /* push what is buffered to disk, e.g. between the points of a sweep */
+    void Flush()
+    {
+        m_out.flush();
+    }
+
+  protected:
+    virtual void DoWrite(const RunParameters &params, const SimulationResults &results) = 0;
+
+    std::vector<char> m_buffer;
+    std::ofstream m_out;
+    uint32_t m_runs; // runs written so far
+};
+
+/*
+ * One table, one row per flow, per BSS and per run ("record" column), with
+ * the run parameters repeated on every row so it loads directly into pandas.
+ */
+class CsvResultsSink : public ResultsSink
+{
+  public:
+    CsvResultsSink(const std::string &fileName)
+        : ResultsSink(fileName, false)
+    {
+        m_out << std::setprecision(10);
+    }
+
+  protected:
+    void DoWrite(const RunParameters &params, const SimulationResults &results) override
+    {
+        if (m_runs == 0)
+        {
+            m_out << "run,record";
+            for (const auto &p : params)
+            {
+                m_out << ',' << CsvQuote(p.first);
+            }
+            m_out << ",bss,sta,port,standard,ac,flowId,txBytes,rxBytes,txPackets,rxPackets,lostPackets,"
+                     "delaySum,jitterSum,timeFirstTxPacket,timeLastRxPacket,throughput,"
+                     "throughputAX,throughputLegacy,wallTime,simTime,events,peakRss,setupTime\n";
+        }
+        std::string prefix;
+        for (const auto &p : params)
+        {
+            // staCounts, walls, lossModels, ... are lists with commas of their own
+            prefix += ',' + CsvQuote(p.second);
+        }
+
+        for (const FlowResult &f : results.flows)
+        {
+            m_out << m_runs << ",flow" << prefix << ',' << f.bss + 1 << ',' << f.sta << ',' << f.port << ','
+                  << (f.ax ? "ax" : "legacy") << ',' << AcName(f.ac) << ',' << f.flowId << ',' << f.txBytes
+                  << ',' << f.rxBytes << ',' << f.txPackets << ',' << f.rxPackets << ',' << f.lostPackets << ','
+                  << f.delaySum << ',' << f.jitterSum << ',' << f.timeFirstTxPacket << ',' << f.timeLastRxPacket
+                  << ',' << f.throughput << ",,,,,,,\n";
+        }
+        for (size_t i = 0; i < results.bss.size(); i++)
+        {
+            const BssResult &b = results.bss[i];
+            m_out << m_runs << ",bss" << prefix << ',' << i + 1 << ",,,,,," << b.txBytes << ',' << b.rxBytes
+                  << ',' << b.txPackets << ',' << b.rxPackets << ',' << b.lostPackets << ',' << b.delaySum
+                  << ',' << b.jitterSum << ",,," << b.throughput << ',' << b.throughputAX << ','
+                  << b.throughputLegacy << ",,,,,\n";
+        }
+        m_out << m_runs << ",total" << prefix << ",,,,,,,,,,,,,,,," << results.totalThroughput << ','
+              << results.throughputAX << ',' << results.throughputLegacy << ',' << results.wallTime << ','
+              << results.simTime << ',' << results.events << ',' << FormatPeakRss(results.peakRss) << ',' << results.setupTime
+              << '\n';
+    }
+};
+
+/* one JSON object per run and line */
+class JsonLinesResultsSink : public ResultsSink
+{
+  public:
+    JsonLinesResultsSink(const std::string &fileName)
+        : ResultsSink(fileName, false)
+    {
+        m_out << std::setprecision(10);
+    }
+
+  protected:
+    void DoWrite(const RunParameters &params, const SimulationResults &results) override
+    {
+        m_out << "{\"run\":" << m_runs << ",\"params\":{";
+        for (size_t i = 0; i < params.size(); i++)
+        {
+            m_out << (i ? "," : "") << JsonQuote(params[i].first) << ':' << JsonQuote(params[i].second);
+        }
+        m_out << "},\"flows\":[";
+        for (size_t i = 0; i < results.flows.size(); i++)
+        {
+            const FlowResult &f = results.flows[i];
+            m_out << (i ? "," : "") << "{\"flowId\":" << f.flowId << ",\"bss\":" << f.bss + 1
+                  << ",\"sta\":" << f.sta << ",\"port\":" << f.port << ",\"standard\":\""
+                  << (f.ax ? "ax" : "legacy") << "\",\"ac\":\"" << AcName(f.ac) << "\",\"txBytes\":" << f.txBytes << ",\"rxBytes\":" << f.rxBytes
+                  << ",\"txPackets\":" << f.txPackets << ",\"rxPackets\":" << f.rxPackets
+                  << ",\"lostPackets\":" << f.lostPackets << ",\"delaySum\":" << f.delaySum
+                  << ",\"jitterSum\":" << f.jitterSum << ",\"timeFirstTxPacket\":" << f.timeFirstTxPacket
+                  << ",\"timeLastRxPacket\":" << f.timeLastRxPacket << ",\"throughput\":" << f.throughput << '}';
+        }
+        m_out << "],\"bss\":[";
+        for (size_t i = 0; i < results.bss.size(); i++)
+        {
+            const BssResult &b = results.bss[i];
+            m_out << (i ? "," : "") << "{\"bss\":" << i + 1 << ",\"txBytes\":" << b.txBytes
+                  << ",\"rxBytes\":" << b.rxBytes << ",\"txPackets\":" << b.txPackets
+                  << ",\"rxPackets\":" << b.rxPackets << ",\"lostPackets\":" << b.lostPackets
+                  << ",\"delaySum\":" << b.delaySum << ",\"jitterSum\":" << b.jitterSum
+                  << ",\"throughput\":" << b.throughput << ",\"throughputAX\":" << b.throughputAX
+                  << ",\"throughputLegacy\":" << b.throughputLegacy << '}';
+        }
+        m_out << "],\"throughputAX\":" << results.throughputAX << ",\"throughputLegacy\":"
+              << results.throughputLegacy << ",\"totalThroughput\":" << results.totalThroughput
+              << ",\"wallTime\":" << results.wallTime << ",\"simTime\":" << results.simTime
+              << ",\"events\":" << results.events << ",\"peakRss\":" << results.peakRss
+              << ",\"setupTime\":" << results.setupTime << "}\n";
+    }
+};
+
+/*
+ * Compact binary records, all numbers little-endian (host order on the x86
+ * boxes we run on):
+ *
+ *   file:   "BSSR" u32 version
+ *   run:    u16 nParams, nParams x (u16 len, name, u16 len, value)
+ *           u32 nFlows, u32 nBss, nFlows x flow, nBss x bss,
+ *           f64 throughputAX, f64 throughputLegacy, f64 totalThroughput, f64 wallTime, f64 simTime,
+ *           u64 events, f64 peakRss, f64 setupTime
+ *   flow:   u32 flowId, u32 bss, u32 sta, u16 port, u8 ax, u8 ac,
+ *           u64 txBytes, u64 rxBytes, u32 txPackets, u32 rxPackets, u32 lostPackets,
+ *           f64 delaySum, f64 jitterSum, f64 timeFirstTxPacket, f64 timeLastRxPacket, f64 throughput
+ *   bss:    u64 txBytes, u64 rxBytes, u64 txPackets, u64 rxPackets, u64 lostPackets,
+ *           f64 delaySum, f64 jitterSum, f64 throughput, f64 throughputAX, f64 throughputLegacy
+ *
+ * bss_results.py reads it; a layout change bumps VERSION there and here.
+ */
+class BinaryResultsSink : public ResultsSink
+{
+  public:
+    static const uint32_t VERSION = 1;
+
+    BinaryResultsSink(const std::string &fileName)
+        : ResultsSink(fileName, true)
+    {
+        m_out.write("BSSR", 4);
+        Put<uint32_t>(VERSION);
+    }
+
+  protected:
+    template <typename T>
+    void Put(T value)
+    {
+        m_out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void PutString(const std::string &s)
+    {
+        Put<uint16_t>(s.size());
+        m_out.write(s.data(), s.size());
+    }
+
+    void DoWrite(const RunParameters &params, const SimulationResults &results) override
+    {
+        Put<uint16_t>(params.size());
+        for (const auto &p : params)
+        {
+            PutString(p.first);
+            PutString(p.second);
+        }
+        Put<uint32_t>(results.flows.size());
+        Put<uint32_t>(results.bss.size());
+        for (const FlowResult &f : results.flows)
+        {
+            Put<uint32_t>(f.flowId);
+            Put<uint32_t>(f.bss + 1);
+            Put<uint32_t>(f.sta);
+            Put<uint16_t>(f.port);
+            Put<uint8_t>(f.ax);
+            Put<uint8_t>(f.ac);
+            Put<uint64_t>(f.txBytes);
+            Put<uint64_t>(f.rxBytes);
+            Put<uint32_t>(f.txPackets);
+            Put<uint32_t>(f.rxPackets);
+            Put<uint32_t>(f.lostPackets);
+            Put<double>(f.delaySum);
+            Put<double>(f.jitterSum);
+            Put<double>(f.timeFirstTxPacket);
+            Put<double>(f.timeLastRxPacket);
+            Put<double>(f.throughput);
+        }
+        for (const BssResult &b : results.bss)
+        {
+            Put<uint64_t>(b.txBytes);
+            Put<uint64_t>(b.rxBytes);
+            Put<uint64_t>(b.txPackets);
+            Put<uint64_t>(b.rxPackets);
+            Put<uint64_t>(b.lostPackets);
+            Put<double>(b.delaySum);
+            Put<double>(b.jitterSum);
+            Put<double>(b.throughput);
+            Put<double>(b.throughputAX);
+            Put<double>(b.throughputLegacy);
+        }
+        Put<double>(results.throughputAX);
+        Put<double>(results.throughputLegacy);
+        Put<double>(results.totalThroughput);
+        Put<double>(results.wallTime);
+        Put<double>(results.simTime);
+        Put<uint64_t>(results.events);
+        Put<double>(results.peakRss);
+        Put<double>(results.setupTime);
+    }
+};
+
+/* "csv", "jsonl" or "bin" */
+inline std::unique_ptr<ResultsSink>
+CreateResultsSink(const std::string &format, const std::string &fileName)
+{
+    if (format == "csv")
+    {
+        return std::unique_ptr<ResultsSink>(new CsvResultsSink(fileName));
+    }
+    if (format == "jsonl")
+    {
+        return std::unique_ptr<ResultsSink>(new JsonLinesResultsSink(fileName));
+    }
+    if (format == "bin")
+    {
+        return std::unique_ptr<ResultsSink>(new BinaryResultsSink(fileName));
+    }
+    NS_FATAL_ERROR("Unknown results format \"" << format << "\", use csv, jsonl or bin");
+    return nullptr;
+}
+
+#endif /* BSS_RESULTS_H */
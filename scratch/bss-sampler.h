@@ -0,0 +1,188 @@
+/*
+ * Per-interval throughput of every BSS and station, streamed to a file.
+ *
+ * ThroughputSampler counts the bytes each PacketSink receives straight from
+ * its RxWithSeqTsSize trace into a plain counter (nothing is allocated or
+ * classified per packet). Bytes are counted exactly as FlowStatsCollector
+ * counts them, the size in the SeqTsSizeHeader plus the IPv4 and UDP
+ * headers, so the samples average out to the throughput in the results.
+ * Every interval it stores the deltas as one row of a fixed-size ring and
+ * writes the ring out whenever it fills up, so the file grows while the run
+ * is going and memory stays constant however long the run is.
+ *
+ * File layout, one block per run (appended):
+ *
+ *     # name=value name=value ...
+ *     time,bss1,bss2,...,bss1_sta0,bss1_sta2,...
+ *     0.1,12.5,11.9,...
+ *
+ * Throughput in Mb/s (1 Mb = 1024 * 1024 bit as in the text report), time is
+ * the end of the interval. bss_results.read_samples() reads it back.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_SAMPLER_H
+#define BSS_SAMPLER_H
+
+#include "bss-results.h"
+
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet.h"
+#include "ns3/seq-ts-size-header.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class ThroughputSampler
+{
+  public:
+    /* headerBytes: added to every packet, the same value the FlowStatsCollector got */
+    ThroughputSampler(ns3::Time interval, uint32_t nBss, uint32_t headerBytes = 28, uint32_t ringRows = 256)
+        : m_interval(interval),
+          m_rows(ringRows),
+          m_used(0),
+          m_nBss(nBss),
+          m_headerBytes(headerBytes),
+          m_buffer(1 << 16)
+    {
+        NS_ABORT_MSG_IF(!interval.IsStrictlyPositive(), "Sampling interval must be positive");
+        NS_ABORT_MSG_IF(ringRows == 0, "Sampler ring needs at least one row");
+    }
+
+    /* count what `sink` (EnableSeqTsSizeHeader) receives as station `sta` of BSS `bss` (0-based); before Start() */
+    void AddStation(uint32_t bss, uint32_t sta, ns3::Ptr<ns3::PacketSink> sink)
+    {
+        m_bytes.push_back(0); // a deque, so the counters never move
+        m_bss.push_back(bss);
+        m_sta.push_back(sta);
+        NS_ABORT_MSG_IF(bss >= m_nBss, "Station of BSS " << bss << " added to a sampler of " << m_nBss << " BSSs");
+        sink->TraceConnectWithoutContext(
+            "RxWithSeqTsSize",
+            ns3::MakeBoundCallback(&ThroughputSampler::CountRx, &m_bytes.back(), m_headerBytes));
+    }
+
+    /* open the file (appending), write the block header and sample until `stop` */
+    void Start(const std::string &fileName, const RunParameters &params, ns3::Time stop)
+    {
+        m_out.rdbuf()->pubsetbuf(m_buffer.data(), m_buffer.size());
+        m_out.open(fileName, std::ios::app);
+        NS_ABORT_MSG_IF(!m_out, "Cannot open sample file " << fileName);
+        m_out << '#';
+        for (const auto &p : params)
+        {
+            m_out << ' ' << p.first << '=' << p.second;
+        }
+        m_out << "\ntime";
+        for (uint32_t b = 0; b < m_nBss; b++)
+        {
+            m_out << ",bss" << b + 1;
+        }
+        for (size_t i = 0; i < m_bytes.size(); i++)
+        {
+            m_out << ",bss" << m_bss[i] + 1 << "_sta" << m_sta[i];
+        }
+        m_out << '\n';
+
+        m_stop = stop;
+        m_last.assign(m_bytes.size(), 0);
+        m_times.assign(m_rows, 0.0);
+        m_deltas.assign(m_rows * m_bytes.size(), 0);
+        m_bssMbps.assign(m_nBss, 0.0);
+        m_event = ns3::Simulator::Schedule(m_interval, &ThroughputSampler::Sample, this);
+    }
+
+    /* write what is left in the ring and close the file; after Simulator::Run() */
+    void Finish()
+    {
+        m_event.Cancel();
+        WriteRing();
+        m_out.close();
+    }
+
+  private:
+    static void CountRx(uint64_t *bytes,
+                        uint32_t headerBytes,
+                        ns3::Ptr<const ns3::Packet> packet,
+                        const ns3::Address &from,
+                        const ns3::Address &to,
+                        const ns3::SeqTsSizeHeader &header)
+    {
+        *bytes += header.GetSize() + headerBytes;
+    }
+
+    void Sample()
+    {
+        size_t n = m_bytes.size();
+        m_times[m_used] = ns3::Simulator::Now().GetSeconds();
+        uint64_t *row = &m_deltas[m_used * n];
+        for (size_t i = 0; i < n; i++)
+        {
+            row[i] = m_bytes[i] - m_last[i];
+            m_last[i] = m_bytes[i];
+        }
+        if (++m_used == m_rows)
+        {
+            WriteRing();
+        }
+        if (ns3::Simulator::Now() + m_interval <= m_stop)
+        {
+            m_event = ns3::Simulator::Schedule(m_interval, &ThroughputSampler::Sample, this);
+        }
+    }
+
+    void WriteRing()
+    {
+        size_t n = m_bytes.size();
+        double toMbps = 8.0 / m_interval.GetSeconds() / 1024 / 1024;
+        for (uint32_t r = 0; r < m_used; r++)
+        {
+            const uint64_t *row = &m_deltas[r * n];
+            std::fill(m_bssMbps.begin(), m_bssMbps.end(), 0.0);
+            for (size_t i = 0; i < n; i++)
+            {
+                m_bssMbps[m_bss[i]] += row[i] * toMbps;
+            }
+            m_out << m_times[r];
+            for (double mbps : m_bssMbps)
+            {
+                m_out << ',' << mbps;
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                m_out << ',' << row[i] * toMbps;
+            }
+            m_out << '\n';
+        }
+        m_used = 0;
+    }
+
+    ns3::Time m_interval;
+    ns3::Time m_stop;
+    uint32_t m_rows;
+    uint32_t m_used; // filled rows of the ring
+    uint32_t m_nBss;
+    uint32_t m_headerBytes;
+    std::deque<uint64_t> m_bytes; // received so far, per station
+    std::vector<uint64_t> m_last; // m_bytes at the previous sample
+    std::vector<uint32_t> m_bss;
+    std::vector<uint32_t> m_sta;
+    std::vector<double> m_times;    // m_rows
+    std::vector<uint64_t> m_deltas; // m_rows x stations
+    std::vector<double> m_bssMbps;
+    std::vector<char> m_buffer;
+    std::ofstream m_out;
+    ns3::EventId m_event;
+};
+
+#endif /* BSS_SAMPLER_H */
@@ -0,0 +1,230 @@
+/*
+ * Scenario files: the setup of an experiment as `name = value` lines.
+ *
+ * The names are the program's command-line options, so a scenario file is
+ * an experiment's command line written down once. ReadScenarioFile() turns
+ * it into "--name=value" arguments that main() hands to its CommandLine
+ * ahead of the real ones, so options given on the command line still win.
+ * Topology, walls, propagation, PHY/MAC settings, traffic and the
+ * measurement window are all options: a new experiment is a new file, not a
+ * rebuild, and the parsed parameters serve every run of a sweep.
+ *
+ *     # two BSSs with a concrete wall halfway between the APs
+ *     d1 = 140
+ *     lossModels = ns3::LogDistancePropagationLossModel+ns3::OhBuildingsPropagationLossModel
+ *     midWall = 0.2:5:3
+ *
+ * '#' starts a comment, values may be put in double quotes. The two parts
+ * that are not plain values, a chain of loss models and the walls, are
+ * built by BuildLossModel() and InstallWalls().
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_SCENARIO_H
+#define BSS_SCENARIO_H
+
+#include "bss-topology.h"
+
+#include "ns3/abort.h"
+#include "ns3/box.h"
+#include "ns3/building.h"
+#include "ns3/buildings-helper.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* `text` without leading and trailing blanks */
+inline std::string
+TrimBlanks(const std::string &text)
+{
+    size_t begin = text.find_first_not_of(" \t\r");
+    return begin == std::string::npos ? "" : text.substr(begin, text.find_last_not_of(" \t\r") + 1 - begin);
+}
+
+/* "--name=value" for every `name = value` line of `fileName`, in file order */
+inline std::vector<std::string>
+ReadScenarioFile(const std::string &fileName)
+{
+    std::ifstream in(fileName);
+    NS_ABORT_MSG_IF(!in, "Cannot open scenario file " << fileName);
+    std::vector<std::string> args;
+    std::string line;
+    for (uint32_t lineNumber = 1; std::getline(in, line); lineNumber++)
+    {
+        line = TrimBlanks(line.substr(0, line.find('#')));
+        if (line.empty())
+        {
+            continue;
+        }
+        size_t eq = line.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos,
+                        fileName << ":" << lineNumber << ": expected name = value, got \"" << line << "\"");
+        std::string name = TrimBlanks(line.substr(0, eq));
+        std::string value = TrimBlanks(line.substr(eq + 1));
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+        {
+            value = value.substr(1, value.size() - 2);
+        }
+        NS_ABORT_MSG_IF(name.empty() || name == "scenario",
+                        fileName << ":" << lineNumber << ": bad option name \"" << name << "\"");
+        args.push_back("--" + name + "=" + value);
+    }
+    return args;
+}
+
+/*
+ * argv with the lines of the --scenario=<file> it names, if any, inserted
+ * right after the program name; `scenario` gets the file name.
+ */
+inline std::vector<std::string>
+ExpandScenarioArguments(int argc, char *argv[], std::string &scenario)
+{
+    std::vector<std::string> args(argv, argv + argc);
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--scenario=", 11) == 0)
+        {
+            scenario = argv[i] + 11;
+        }
+    }
+    if (!scenario.empty())
+    {
+        std::vector<std::string> fromFile = ReadScenarioFile(scenario);
+        args.insert(args.begin() + 1, fromFile.begin(), fromFile.end());
+    }
+    return args;
+}
+
+/*
+ * "ns3::LogDistancePropagationLossModel+ns3::OhBuildingsPropagationLossModel":
+ * the models created by TypeId and chained with SetNext(), so their losses add
+ * up the way YansWifiChannelHelper::AddPropagationLoss() chains them.
+ */
+inline ns3::Ptr<ns3::PropagationLossModel>
+BuildLossModel(const std::string &spec)
+{
+    ns3::Ptr<ns3::PropagationLossModel> first;
+    ns3::Ptr<ns3::PropagationLossModel> last;
+    std::istringstream iss(spec);
+    std::string name;
+    while (std::getline(iss, name, '+'))
+    {
+        ns3::TypeId tid;
+        NS_ABORT_MSG_IF(!ns3::TypeId::LookupByNameFailSafe(name, &tid) ||
+                            !tid.IsChildOf(ns3::PropagationLossModel::GetTypeId()),
+                        "\"" << name << "\" is not a propagation loss model");
+        ns3::ObjectFactory factory;
+        factory.SetTypeId(tid);
+        ns3::Ptr<ns3::PropagationLossModel> model = factory.Create<ns3::PropagationLossModel>();
+        if (last)
+        {
+            last->SetNext(model);
+        }
+        else
+        {
+            first = model;
+        }
+        last = model;
+    }
+    NS_ABORT_MSG_IF(!first, "No propagation loss model in \"" << spec << "\"");
+    return first;
+}
+
+/* "xMin:xMax:yMin:yMax:zMin:zMax;..." */
+inline std::vector<ns3::Box>
+ParseWalls(const std::string &spec)
+{
+    std::vector<ns3::Box> walls;
+    std::istringstream boxes(spec);
+    std::string item;
+    while (std::getline(boxes, item, ';'))
+    {
+        if (item.empty())
+        {
+            continue;
+        }
+        double v[6];
+        char sep[5];
+        std::istringstream iss(item);
+        iss >> v[0];
+        for (uint32_t k = 0; k < 5; k++)
+        {
+            iss >> sep[k] >> v[k + 1];
+            NS_ABORT_MSG_IF(!iss || sep[k] != ':',
+                            "Bad wall \"" << item << "\", expected xMin:xMax:yMin:yMax:zMin:zMax");
+        }
+        walls.emplace_back(v[0], v[1], v[2], v[3], v[4], v[5]);
+    }
+    return walls;
+}
+
+/*
+ * "thickness:length:height": a wall halfway between every two neighbouring
+ * APs of a line layout, across the line and standing on the ground.
+ */
+inline std::vector<ns3::Box>
+MidpointWalls(BssTopology &topology, const std::string &spec)
+{
+    std::vector<ns3::Box> walls;
+    if (spec.empty())
+    {
+        return walls;
+    }
+    double thickness;
+    double length;
+    double height;
+    char c1;
+    char c2;
+    std::istringstream iss(spec);
+    NS_ABORT_MSG_IF(!(iss >> thickness >> c1 >> length >> c2 >> height) || c1 != ':' || c2 != ':',
+                    "Bad midWall \"" << spec << "\", expected thickness:length:height");
+    std::vector<ns3::Vector> aps;
+    for (uint32_t i = 0; i < topology.GetNBss(); i++)
+    {
+        aps.push_back(topology.GetBss(i).ap->GetObject<ns3::MobilityModel>()->GetPosition());
+        NS_ABORT_MSG_IF(aps.back().y != aps.front().y, "midWall needs the APs on one line along x");
+    }
+    std::sort(aps.begin(), aps.end(), [](const ns3::Vector &a, const ns3::Vector &b) { return a.x < b.x; });
+    for (uint32_t i = 1; i < aps.size(); i++)
+    {
+        double x = (aps[i - 1].x + aps[i].x) / 2;
+        double y = aps[i].y;
+        walls.emplace_back(x - thickness / 2, x + thickness / 2, y - length / 2, y + length / 2, 0.0, height);
+    }
+    return walls;
+}
+
+/*
+ * One single-room residential building with concrete walls per box, then
+ * the building info on every node (the buildings loss models need it on all
+ * of them, walls or not). After mobility, before the link cache.
+ */
+inline void
+InstallWalls(const std::vector<ns3::Box> &walls)
+{
+    for (const ns3::Box &box : walls)
+    {
+        ns3::Ptr<ns3::Building> building = ns3::CreateObject<ns3::Building>();
+        building->SetBoundaries(box);
+        building->SetBuildingType(ns3::Building::Residential);
+        building->SetExtWallsType(ns3::Building::ConcreteWithWindows);
+        building->SetNFloors(1);
+        building->SetNRoomsX(1);
+        building->SetNRoomsY(1);
+    }
+    ns3::BuildingsHelper::Install(ns3::NodeContainer::GetGlobal());
+}
+
+#endif /* BSS_SCENARIO_H */
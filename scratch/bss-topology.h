@@ -0,0 +1,300 @@
+/*
+ * Node layout of a multi-BSS deployment.
+ *
+ * BssTopology creates the AP and station nodes of nAP BSSs, places them on a
+ * line (the original two-AP layout), square grid, hex grid or at random, and
+ * gives every BSS its own /24 subnet and BSS color. Device installation stays
+ * with the program, which knows its PHY/MAC settings, and walks GetBss(i).
+ * Every step is a single pass over the nodes; SetupTimer records the wall
+ * time and peak RSS after each of them.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_TOPOLOGY_H
+#define BSS_TOPOLOGY_H
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* the nodes, devices and addressing of one BSS */
+struct BssNodes
+{
+    ns3::Ptr<ns3::Node> ap;
+    ns3::NodeContainer sta;       // 802.11ax stations
+    ns3::NodeContainer staLegacy; // 802.11a stations
+    ns3::NetDeviceContainer apDevice;
+    ns3::NetDeviceContainer staDevices;
+    ns3::NetDeviceContainer staDevicesLegacy;
+    ns3::Ipv4Address network; // x.y.z.0/24
+    uint8_t color = 0;        // BSS color, 1..63
+};
+
+struct TopologyParameters
+{
+    std::string layout = "line";       // line, grid, hex or random
+    std::string staPlacement = "fixed"; // fixed or disc
+    uint32_t nAP = 2;
+    double apDistance = 140; // m, between neighbouring APs (d1)
+    double staDistance = 2;  // m, AP to station, disc radius with staPlacement=disc (d2)
+    double height = 1.0;     // m, of every node
+    bool reverse = false;    // BSS i takes the place of BSS nAP-1-i (the second two-AP scenario)
+    int64_t stream = -1;     // RNG stream of the random placements, the next free one if negative
+    std::vector<uint32_t> nSta;       // per BSS
+    std::vector<uint32_t> nStaLegacy; // per BSS
+};
+
+/*
+ * "a,b,c" gives one count per BSS, a single value or an empty string (then
+ * `fallback`) the same count for all of them.
+ */
+inline std::vector<uint32_t>
+ParseStationCounts(const std::string &spec, uint32_t nAP, uint32_t fallback)
+{
+    std::vector<uint32_t> counts;
+    std::istringstream iss(spec);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        if (!item.empty())
+        {
+            counts.push_back(std::stoul(item));
+        }
+    }
+    if (counts.empty())
+    {
+        counts.push_back(fallback);
+    }
+    if (counts.size() == 1)
+    {
+        counts.assign(nAP, counts[0]);
+    }
+    NS_ABORT_MSG_IF(counts.size() != nAP,
+                    "Station counts \"" << spec << "\" give " << counts.size() << " values for " << nAP << " BSSs");
+    return counts;
+}
+
+/* wall time and peak RSS at the end of each named setup phase */
+class SetupTimer
+{
+  public:
+    SetupTimer()
+        : m_start(std::chrono::steady_clock::now()),
+          m_last(m_start)
+    {
+    }
+
+    void Mark(const std::string &phase)
+    {
+        auto now = std::chrono::steady_clock::now();
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        m_phases.push_back({phase, std::chrono::duration<double>(now - m_last).count(), usage.ru_maxrss});
+        m_last = now;
+    }
+
+    double GetTotal() const
+    {
+        return std::chrono::duration<double>(m_last - m_start).count();
+    }
+
+    void Print(std::ostream &os) const
+    {
+        os << "Setup time" << '\n';
+        for (const Phase &p : m_phases)
+        {
+            os << "  " << p.name << ":\t" << p.seconds * 1e3 << " ms\tpeak RSS " << p.maxRssKiB / 1024 << " MiB"
+               << '\n';
+        }
+        os << "  total:\t" << GetTotal() * 1e3 << " ms" << std::endl;
+    }
+
+  private:
+    struct Phase
+    {
+        std::string name;
+        double seconds;
+        long maxRssKiB;
+    };
+
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_last;
+    std::vector<Phase> m_phases;
+};
+
+class BssTopology
+{
+  public:
+    explicit BssTopology(const TopologyParameters &params)
+        : m_params(params)
+    {
+        NS_ABORT_MSG_IF(params.nAP == 0, "Need at least one AP");
+        NS_ABORT_MSG_IF(params.nSta.size() != params.nAP || params.nStaLegacy.size() != params.nAP,
+                        "Need one station count per BSS");
+        NS_ABORT_MSG_IF(params.layout != "line" && params.layout != "grid" && params.layout != "hex" &&
+                            params.layout != "random",
+                        "Unknown layout " << params.layout << ", expected line, grid, hex or random");
+        NS_ABORT_MSG_IF(params.staPlacement != "fixed" && params.staPlacement != "disc",
+                        "Unknown staPlacement " << params.staPlacement << ", expected fixed or disc");
+        // up to 256 BSSs keep the original 192.168.i.0 plan, beyond that 10.(i/256).(i%256).0
+        m_base = ns3::Ipv4Address(params.nAP <= 256 ? "192.168.0.0" : "10.0.0.0");
+        NS_ABORT_MSG_IF(params.nAP > 65536, "At most 65536 BSSs fit in 10.0.0.0/8");
+    }
+
+    /* all APs first, then the AX and legacy stations BSS by BSS (the original node ids) */
+    void CreateNodes()
+    {
+        m_apNodes.Create(m_params.nAP);
+        m_bss.resize(m_params.nAP);
+        for (uint32_t i = 0; i < m_params.nAP; i++)
+        {
+            BssNodes &bss = m_bss[i];
+            NS_ABORT_MSG_IF(m_params.nSta[i] + m_params.nStaLegacy[i] > 253,
+                            "BSS " << i << " has more stations than its /24 can address");
+            bss.ap = m_apNodes.Get(i);
+            bss.sta.Create(m_params.nSta[i]);
+            bss.staLegacy.Create(m_params.nStaLegacy[i]);
+            bss.network = ns3::Ipv4Address(m_base.Get() + (i << 8));
+            bss.color = i % 63 + 1;
+        }
+    }
+
+    /* a constant position model per node, no position allocator in between */
+    void InstallMobility()
+    {
+        if (m_params.layout == "random" || m_params.staPlacement == "disc")
+        {
+            m_random = ns3::CreateObject<ns3::UniformRandomVariable>();
+            if (m_params.stream >= 0)
+            {
+                // a stream of its own: the positions only depend on the run number (its substream)
+                m_random->SetStream(m_params.stream);
+            }
+        }
+        for (uint32_t i = 0; i < m_params.nAP; i++)
+        {
+            BssNodes &bss = m_bss[i];
+            uint32_t slot = m_params.reverse ? m_params.nAP - 1 - i : i;
+            ns3::Vector ap = ApPosition(slot);
+            SetPosition(bss.ap, ap);
+            uint32_t n = bss.sta.GetN() + bss.staLegacy.GetN();
+            for (uint32_t j = 0; j < n; j++)
+            {
+                ns3::Ptr<ns3::Node> node = j < bss.sta.GetN() ? bss.sta.Get(j) : bss.staLegacy.Get(j - bss.sta.GetN());
+                SetPosition(node, StaPosition(slot, ap, j, n));
+            }
+        }
+    }
+
+    /* AP gets .1, then the AX and the legacy stations; call after the stack is installed */
+    void AssignAddresses()
+    {
+        ns3::Ipv4AddressHelper address;
+        for (BssNodes &bss : m_bss)
+        {
+            address.SetBase(bss.network, "255.255.255.0");
+            address.Assign(bss.apDevice);
+            address.Assign(bss.staDevices);
+            address.Assign(bss.staDevicesLegacy);
+        }
+    }
+
+    uint32_t GetNBss() const
+    {
+        return m_bss.size();
+    }
+
+    BssNodes &GetBss(uint32_t i)
+    {
+        return m_bss[i];
+    }
+
+    const ns3::NodeContainer &GetApNodes() const
+    {
+        return m_apNodes;
+    }
+
+    /* index of the BSS whose subnet holds addr, -1 if none */
+    int FindBss(ns3::Ipv4Address addr) const
+    {
+        uint32_t i = (addr.Get() - m_base.Get()) >> 8;
+        return i < m_bss.size() ? static_cast<int>(i) : -1;
+    }
+
+  private:
+    ns3::Vector ApPosition(uint32_t i) const
+    {
+        double d = m_params.apDistance;
+        uint32_t cols = std::ceil(std::sqrt(static_cast<double>(m_params.nAP)));
+        uint32_t row = i / cols;
+        uint32_t col = i % cols;
+        if (m_params.layout == "grid")
+        {
+            return ns3::Vector(col * d, row * d, m_params.height);
+        }
+        if (m_params.layout == "hex")
+        {
+            return ns3::Vector(col * d + (row % 2) * d / 2, row * d * std::sqrt(3.0) / 2, m_params.height);
+        }
+        if (m_params.layout == "random")
+        {
+            // same AP density as the square grid
+            double side = d * std::sqrt(static_cast<double>(m_params.nAP));
+            return ns3::Vector(m_random->GetValue(0, side), m_random->GetValue(0, side), m_params.height);
+        }
+        return ns3::Vector(i * d, 0.0, m_params.height);
+    }
+
+    /* station j of n around the AP in place i */
+    ns3::Vector StaPosition(uint32_t i, const ns3::Vector &ap, uint32_t j, uint32_t n) const
+    {
+        double d = m_params.staDistance;
+        if (m_params.staPlacement == "disc")
+        {
+            double rho = d * std::sqrt(m_random->GetValue());
+            double theta = m_random->GetValue(0, 2 * M_PI);
+            return ns3::Vector(ap.x + rho * std::cos(theta), ap.y + rho * std::sin(theta), m_params.height);
+        }
+        if (m_params.layout == "line")
+        {
+            // as in the two-AP setup: stations of the first AP behind it, the others past theirs
+            return ns3::Vector(i == 0 ? ap.x - d : ap.x + d, ap.y, m_params.height);
+        }
+        double theta = 2 * M_PI * j / n;
+        return ns3::Vector(ap.x + d * std::cos(theta), ap.y + d * std::sin(theta), m_params.height);
+    }
+
+    static void SetPosition(ns3::Ptr<ns3::Node> node, const ns3::Vector &position)
+    {
+        ns3::Ptr<ns3::ConstantPositionMobilityModel> mobility =
+            ns3::CreateObject<ns3::ConstantPositionMobilityModel>();
+        mobility->SetPosition(position);
+        node->AggregateObject(mobility);
+    }
+
+    TopologyParameters m_params;
+    ns3::Ipv4Address m_base;
+    ns3::NodeContainer m_apNodes;
+    std::vector<BssNodes> m_bss;
+    ns3::Ptr<ns3::UniformRandomVariable> m_random;
+};
+
+#endif /* BSS_TOPOLOGY_H */
@@ -0,0 +1,221 @@
+/*
+ * Traffic sources for the BSS scenarios.
+ *
+ * FullBufferApplication keeps a station saturated without a rate to tune: it
+ * only hands a packet to its UDP socket when the Wi-Fi MAC queue of the
+ * packet's access category has room, and tops the queue up again when MPDUs
+ * leave it. A constant-rate OnOff source far above the PHY rate produces the
+ * same saturation, but pays one event and one Packet per generated packet and
+ * most of them end up dropped at the full queue.
+ *
+ * Like OnOffApplication it takes the socket factory as its Protocol
+ * attribute, so it also runs over PacketSocketFactory straight on the Wi-Fi
+ * device, without an IP stack.
+ *
+ * Shared by the scratch programs, so it only uses NS_FATAL_ERROR / NS_ASSERT
+ * and no log component of its own.
+ */
+
+#ifndef BSS_TRAFFIC_H
+#define BSS_TRAFFIC_H
+
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/assert.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/packet-sink.h"
+#include "ns3/qos-utils.h"
+#include "ns3/seq-ts-size-header.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+#include "ns3/type-id.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-mpdu.h"
+#include "ns3/wifi-net-device.h"
+
+#include <algorithm>
+#include <cstdint>
+
+class FullBufferApplication : public ns3::Application
+{
+  public:
+    static ns3::TypeId GetTypeId()
+    {
+        static ns3::TypeId tid =
+            ns3::TypeId("FullBufferApplication")
+                .SetParent<ns3::Application>()
+                .SetGroupName("Applications")
+                .AddConstructor<FullBufferApplication>()
+                .AddAttribute("Remote",
+                              "The address of the destination",
+                              ns3::AddressValue(),
+                              ns3::MakeAddressAccessor(&FullBufferApplication::m_peer),
+                              ns3::MakeAddressChecker())
+                .AddAttribute("Protocol",
+                              "The socket factory to send with",
+                              ns3::TypeIdValue(ns3::UdpSocketFactory::GetTypeId()),
+                              ns3::MakeTypeIdAccessor(&FullBufferApplication::m_protocol),
+                              ns3::MakeTypeIdChecker())
+                .AddAttribute("PacketSize",
+                              "Payload size of every packet",
+                              ns3::UintegerValue(1472),
+                              ns3::MakeUintegerAccessor(&FullBufferApplication::m_packetSize),
+                              ns3::MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("QueueDepth",
+                              "Packets to keep in the MAC queue, 0 fills it up to its MaxSize",
+                              ns3::UintegerValue(0),
+                              ns3::MakeUintegerAccessor(&FullBufferApplication::m_queueDepth),
+                              ns3::MakeUintegerChecker<uint32_t>())
+                .AddAttribute("EnableSeqTsSizeHeader",
+                              "Start every packet with a SeqTsSizeHeader (within PacketSize), as OnOffApplication does",
+                              ns3::BooleanValue(false),
+                              ns3::MakeBooleanAccessor(&FullBufferApplication::m_enableSeqTsSizeHeader),
+                              ns3::MakeBooleanChecker())
+                .AddAttribute("RetryInterval",
+                              "When a top-up did not reach the MAC queue (e.g. not yet associated), "
+                              "try again after this long",
+                              ns3::TimeValue(ns3::MilliSeconds(1)),
+                              ns3::MakeTimeAccessor(&FullBufferApplication::m_retryInterval),
+                              ns3::MakeTimeChecker())
+                .AddTraceSource("Tx",
+                                "A new packet was accepted by the socket",
+                                ns3::MakeTraceSourceAccessor(&FullBufferApplication::m_txTrace),
+                                "ns3::Packet::TracedCallback");
+        return tid;
+    }
+
+    /* packets handed to the socket so far */
+    uint64_t GetSent() const
+    {
+        return m_sent;
+    }
+
+  private:
+    void StartApplication() override
+    {
+        ns3::Ptr<ns3::WifiNetDevice> device;
+        for (uint32_t i = 0; i < GetNode()->GetNDevices() && !device; i++)
+        {
+            device = ns3::DynamicCast<ns3::WifiNetDevice>(GetNode()->GetDevice(i));
+        }
+        NS_ABORT_MSG_IF(!device, "FullBufferApplication needs a Wi-Fi device on node " << GetNode()->GetId());
+
+        NS_ABORT_MSG_IF(m_enableSeqTsSizeHeader && m_packetSize < ns3::SeqTsSizeHeader().GetSerializedSize(),
+                        "PacketSize " << m_packetSize << " is too small for a SeqTsSizeHeader");
+        m_socket = ns3::Socket::CreateSocket(GetNode(), m_protocol);
+        m_socket->Bind();
+        m_socket->Connect(m_peer);
+
+        // the MAC maps the three precedence bits of the TOS to the TID, packet sockets send with TID 0
+        uint8_t tos = ns3::InetSocketAddress::IsMatchingType(m_peer)
+                          ? ns3::InetSocketAddress::ConvertFrom(m_peer).GetTos()
+                          : 0;
+        m_queue = device->GetMac()->GetTxopQueue(ns3::QosUtilsMapTidToAc(tos >> 5));
+        NS_ABORT_MSG_IF(m_queue->GetMaxSize().GetUnit() != ns3::QueueSizeUnit::PACKETS,
+                        "FullBufferApplication needs a MAC queue sized in packets");
+        uint32_t capacity = m_queue->GetMaxSize().GetValue();
+        m_target = m_queueDepth ? std::min(m_queueDepth, capacity) : capacity;
+        m_queue->TraceConnectWithoutContext("Dequeue", ns3::MakeCallback(&FullBufferApplication::Dequeued, this));
+
+        m_running = true;
+        Refill();
+    }
+
+    void StopApplication() override
+    {
+        m_running = false;
+        m_refillEvent.Cancel();
+        if (m_queue)
+        {
+            m_queue->TraceDisconnectWithoutContext("Dequeue",
+                                                   ns3::MakeCallback(&FullBufferApplication::Dequeued, this));
+        }
+        if (m_socket)
+        {
+            m_socket->Close();
+            m_socket = nullptr;
+        }
+    }
+
+    /* MPDUs acked, expired or dropped: one top-up per instant, however many left */
+    void Dequeued(ns3::Ptr<const ns3::WifiMpdu> mpdu)
+    {
+        if (m_running && !m_refillEvent.IsRunning())
+        {
+            m_refillEvent = ns3::Simulator::ScheduleNow(&FullBufferApplication::Refill, this);
+        }
+    }
+
+    /* send what is missing to the target depth; the stack puts it in the MAC queue synchronously */
+    void Refill()
+    {
+        uint32_t queued = m_queue->GetNPackets();
+        // after a top-up that went nowhere, probe with a single packet
+        uint32_t missing = queued < m_target ? m_target - queued : 0;
+        uint32_t budget = m_stalled ? std::min<uint32_t>(1, missing) : missing;
+        for (uint32_t i = 0; i < budget; i++)
+        {
+            ns3::Ptr<ns3::Packet> packet = CreatePacket();
+            if (m_socket->Send(packet) < 0)
+            {
+                break;
+            }
+            m_txTrace(packet);
+            m_sent++;
+        }
+        // nothing arrived (no association yet, device stopped): no Dequeue will wake us up
+        m_stalled = budget > 0 && m_queue->GetNPackets() <= queued;
+        if (m_stalled)
+        {
+            m_refillEvent = ns3::Simulator::Schedule(m_retryInterval, &FullBufferApplication::Refill, this);
+        }
+    }
+
+    /* PacketSize bytes, the sequence number and send time up front if enabled */
+    ns3::Ptr<ns3::Packet> CreatePacket()
+    {
+        if (!m_enableSeqTsSizeHeader)
+        {
+            return ns3::Create<ns3::Packet>(m_packetSize);
+        }
+        ns3::SeqTsSizeHeader header; // time stamped now
+        header.SetSeq(m_sent);
+        header.SetSize(m_packetSize);
+        ns3::Ptr<ns3::Packet> packet = ns3::Create<ns3::Packet>(m_packetSize - header.GetSerializedSize());
+        packet->AddHeader(header);
+        return packet;
+    }
+
+    ns3::Address m_peer;
+    ns3::TypeId m_protocol;
+    uint32_t m_packetSize;
+    uint32_t m_queueDepth;
+    bool m_enableSeqTsSizeHeader;
+    ns3::Time m_retryInterval;
+    ns3::Ptr<ns3::Socket> m_socket;
+    ns3::Ptr<ns3::WifiMacQueue> m_queue;
+    uint32_t m_target = 0;
+    bool m_running = false;
+    bool m_stalled = false;
+    uint64_t m_sent = 0;
+    ns3::EventId m_refillEvent;
+    ns3::TracedCallback<ns3::Ptr<const ns3::Packet>> m_txTrace;
+};
+
+/* the two ends of one station's traffic, as installed by the programs */
+struct TrafficFlow
+{
+    uint32_t id = 0;                   // FlowRegistry id
+    ns3::Ptr<ns3::Application> source; // OnOffApplication or FullBufferApplication, over UDP or a packet socket
+    ns3::Ptr<ns3::PacketSink> sink;
+};
+
+#endif /* BSS_TRAFFIC_H */
@@ -0,0 +1,366 @@
+#!/usr/bin/env python3
+
+"""Run a 2BSS parameter grid on all local cores.
+
+The compiled scratch binary is started directly (no ./ns3 run wrapper), one
+process per (point, rngRun). Jobs sit in one shared queue, longest first, and
+every worker takes the next job as soon as it is done with the previous one,
+so short and long runs mixed in the same grid keep all cores busy.
+
+Example (same grid as Sym_2_2BSS_ApSta.py):
+
+    ./sweep_runner.py --program 2BSS --param d1=100:380:20 \
+        --param obssPdThreshold=-64,-72,-78 --param enableObssPd=1,0 --runs 5
+
+With --scenario every run reads its defaults from that scenario file (the
+wall setup is scenarios/2bss-wall-1.conf); --param values override it.
+
+With --ci-target the --runs replications are only the first round: points
+whose 95% CI half-width is still wider than the target get more rngRun
+replications, as many as the current spread says are needed, in further
+rounds until they meet it or reach --max-runs.
+
+With --prescreen MARGIN the analytical model of bss_model.py predicts every
+point first. Points it is sure about (no RSSI or SINR within MARGIN dB of a
+threshold) get only --prescreen-runs replications, none by default, and keep
+the prediction in the summary; the simulations go to the points near the
+transitions.
+
+--param phy=yans,spectrum runs every point on both PHY backends; the runs
+table has the wall time, executed events and peak RSS of each run.
+
+Results are cached (bss_cache.py, in --cache) by binary, ns-3 libraries
+and the run's resolved parameters: re-running an interrupted or extended
+sweep only simulates the runs that are not in the cache yet.
+"""
+
+import argparse
+import csv
+import math
+import glob
+import itertools
+import os
+import queue
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+import numpy as np
+import scipy.stats as stats
+
+from bss_cache import ResultsCache
+from bss_model import predict
+from bss_results import read_jsonl
+
+# default duration of the C++ program, used to estimate the cost of a job
+DEFAULT_DURATION = 60.0
+
+
+def parse_values(spec):
+    """"a,b,c" is a list, "start:stop:step" a range with stop excluded (like np.arange)."""
+    if ':' in spec:
+        start, stop, step = (float(x) for x in spec.split(':'))
+        return [format_value(v) for v in np.arange(start, stop, step)]
+    return [v.strip() for v in spec.split(',') if v.strip()]
+
+
+def format_value(v):
+    v = float(v)
+    return str(int(v)) if v.is_integer() else str(v)
+
+
+def is_true(value):
+    return str(value).lower() in ('1', 'true')
+
+
+def read_scenario(path):
+    """The name = value lines of a scenario file as a dict (see scratch/bss-scenario.h)."""
+    options = {}
+    with open(path) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if line:
+                name, _, value = line.partition('=')
+                options[name.strip()] = value.strip().strip('"')
+    return options
+
+
+def find_binary(program, ns3_dir):
+    """Locate build/scratch/ns3.<version>-<program>-<profile> in the ns-3 tree."""
+    pattern = os.path.join(ns3_dir, 'build', 'scratch', f'ns3*-{program}-*')
+    candidates = [c for c in glob.glob(pattern) if os.access(c, os.X_OK)]
+    if not candidates:
+        sys.exit(f"No binary matching {pattern}, build it first with './ns3 build {program}'")
+    # newest build wins if several profiles are around
+    return max(candidates, key=os.path.getmtime)
+
+
+def build_points(params):
+    """Cartesian product of the --param grid; threshold collapses when OBSS_PD is off."""
+    names = list(params)
+    points = []
+    seen = set()
+    for values in itertools.product(*(params[n] for n in names)):
+        point = dict(zip(names, values))
+        if 'enableObssPd' in point and not is_true(point['enableObssPd']):
+            point.pop('obssPdThreshold', None)
+        key = tuple(sorted(point.items()))
+        if key not in seen:
+            seen.add(key)
+            points.append(point)
+    return points
+
+
+def build_jobs(points, runs, rng_run_base, duration=DEFAULT_DURATION, first=0):
+    """One job per (point, rngRun); replication k of every point uses run number base + k.
+
+    `runs` and `first` are one value for all points or a list with one per
+    point; replications first .. first + runs - 1 are built. `duration` is
+    the run length of points that do not set one.
+    """
+    runs = runs if isinstance(runs, list) else [runs] * len(points)
+    first = first if isinstance(first, list) else [first] * len(points)
+    jobs = []
+    for index, point in enumerate(points):
+        for k in range(first[index], first[index] + runs[index]):
+            jobs.append({'point': index, 'params': point, 'rngRun': rng_run_base + k})
+    keys = [(j['point'], j['rngRun']) for j in jobs]
+    assert len(keys) == len(set(keys)), "two jobs share a (point, rngRun)"
+    for job in jobs:
+        job['cost'] = float(job['params'].get('duration', duration))
+    # longest jobs first so the tail of the sweep is made of short ones
+    jobs.sort(key=lambda j: -j['cost'])
+    return jobs
+
+
+def run_program(binary, args, env, results_file):
+    """Run the program once and read back the JSON lines record it writes to `results_file`.
+
+    The record gets the process wall time as 'processTime'; a failed run
+    gives {'error': <last stderr line>, 'processTime': ...}. The results
+    file is removed either way.
+    """
+    start = time.time()
+    process = subprocess.run([binary] + args + [f"--resultsFile={results_file}", "--resultsFormat=jsonl"],
+                             stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True, env=env)
+    wall = time.time() - start
+    result = None
+    error = process.stderr.strip().split('\n')[-1] if process.stderr else f"exit {process.returncode}"
+    if process.returncode == 0 and os.path.exists(results_file):
+        try:
+            result = read_jsonl(results_file)[0]
+        except (IndexError, ValueError) as e:
+            error = f"unreadable results file: {e}"
+    # the program creates the file at startup, a failed run can leave it behind
+    if os.path.exists(results_file):
+        os.remove(results_file)
+    if result is None:
+        result = {'error': error}
+    result['processTime'] = wall
+    return result
+
+
+def run_job(binary, job, extra_args, env, work_dir, cache=None):
+    """Run one simulation and read back the JSON lines record it writes (or take it from the cache)."""
+    results_file = os.path.join(work_dir, f"job-{job['point']}-{job['rngRun']}.jsonl")
+    args = [f"--{k}={v}" for k, v in job['params'].items()] + [f"--rngRun={job['rngRun']}"] + extra_args
+    key = cache.key(binary, args) if cache is not None else None
+    if key is not None:
+        result = cache.get(key)
+        if result is not None:
+            result['cached'] = True
+            return result
+    result = run_program(binary, args, env, results_file)
+    # the runs table reports the cost of the whole process
+    result['wallTime'] = result.pop('processTime')
+    if key is not None and 'error' not in result:
+        cache.put(key, result)
+    return result
+
+
+def run_jobs(binary, jobs, workers, extra_args=(), ns3_dir='.', on_result=None, cache=None):
+    """Keep `workers` processes busy from one shared queue; fills job['result'] of every job.
+
+    With a ResultsCache, runs found in it are not started again.
+    """
+    env = dict(os.environ)
+    lib_dir = os.path.join(os.path.abspath(ns3_dir), 'build', 'lib')
+    env['LD_LIBRARY_PATH'] = lib_dir + os.pathsep + env.get('LD_LIBRARY_PATH', '')
+
+    work_dir = tempfile.mkdtemp(prefix='sweep-')
+    pending = queue.Queue()
+    for job in jobs:
+        pending.put(job)
+    lock = threading.Lock()
+    done = [0]
+
+    def worker():
+        while True:
+            try:
+                job = pending.get_nowait()
+            except queue.Empty:
+                return
+            job['result'] = run_job(binary, job, list(extra_args), env, work_dir, cache)
+            with lock:
+                done[0] += 1
+                status = job['result'].get('error', f"{job['result'].get('totalThroughput', float('nan')):.2f} Mbps")
+                source = 'cached' if job['result'].get('cached') else f"{job['result']['wallTime']:.1f} s"
+                print(f"[{done[0]}/{len(jobs)}] {job['params']} rngRun={job['rngRun']}: {status} ({source})",
+                      flush=True)
+                if on_result is not None:
+                    on_result(job)
+
+    threads = [threading.Thread(target=worker) for _ in range(min(workers, len(jobs)))]
+    try:
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+    return jobs
+
+
+def summarize(points, jobs, metric='totalThroughput'):
+    """Mean and t-distribution 95% CI (sample standard deviation) of `metric` per point."""
+    rows = []
+    for index, point in enumerate(points):
+        values = [j['result'][metric] for j in jobs
+                  if j['point'] == index and metric in j.get('result', {})]
+        n = len(values)
+        mean = np.mean(values) if n else None
+        margin = stats.t.ppf(0.975, n - 1) * np.std(values, ddof=1) / np.sqrt(n) if n > 1 else None
+        rows.append(dict(point, runs=n, mean=mean, ci95=margin))
+    return rows
+
+
+def parse_ci_target(spec):
+    """"0.5" is an absolute 95% CI half-width (in the metric's unit), "2%" one relative to the point's mean."""
+    if spec.endswith('%'):
+        return float(spec[:-1]) / 100, True
+    return float(spec), False
+
+
+def more_runs(rows, attempted, target, relative, max_runs):
+    """Replications to add per point so its CI half-width gets down to the target, capped at max_runs in all."""
+    extra = []
+    for row, tried in zip(rows, attempted):
+        room = max_runs - tried
+        n = row['runs']
+        if room <= 0:
+            extra.append(0)
+        elif n < 2 or row['ci95'] is None:
+            extra.append(min(room, 2 - n if n < 2 else 1))
+        else:
+            width = target * abs(row['mean']) if relative else target
+            if row['ci95'] <= width:
+                extra.append(0)
+            elif width <= 0:
+                extra.append(room)
+            else:
+                # the half-width shrinks with sqrt(n): n * (ci / width)^2 runs at the current spread
+                needed = math.ceil(n * (row['ci95'] / width) ** 2)
+                extra.append(min(room, max(1, needed - n)))
+    return extra
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--program', default='2BSS', help="scratch program name")
+    parser.add_argument('--scenario', help="scenario file every run starts from")
+    parser.add_argument('--binary', help="path of the compiled program, found under build/scratch by default")
+    parser.add_argument('--ns3-dir', default='.', help="ns-3 top level directory")
+    parser.add_argument('--param', action='append', default=[], metavar='NAME=VALUES',
+                        help="grid axis, VALUES is \"a,b,c\" or \"start:stop:step\"")
+    parser.add_argument('--runs', type=int, default=5, help="replications per point (first round with --ci-target)")
+    parser.add_argument('--ci-target', metavar='WIDTH',
+                        help="add replications until the 95%% CI half-width of totalThroughput is at most WIDTH "
+                             "Mb/s, or WIDTH%% of the mean when it ends in %%")
+    parser.add_argument('--max-runs', type=int, default=30, help="replication cap per point with --ci-target")
+    parser.add_argument('--prescreen', type=float, metavar='MARGIN',
+                        help="predict every point analytically and run fewer replications of the points whose "
+                             "prediction is at least MARGIN dB away from any threshold")
+    parser.add_argument('--prescreen-runs', type=int, default=0,
+                        help="replications of a point the prediction is sure about")
+    parser.add_argument('--rng-run-base', type=int, default=101, help="rngRun of the first replication")
+    parser.add_argument('--jobs', type=int, default=os.cpu_count(), help="parallel workers")
+    parser.add_argument('--cache', default='.results_cache', help="results cache directory")
+    parser.add_argument('--no-cache', action='store_true', help="run everything and leave the cache alone")
+    parser.add_argument('--output', default='sweep_runs.csv', help="one row per (point, rngRun)")
+    parser.add_argument('--summary', default='sweep_summary.csv', help="one row per point")
+    parser.add_argument('extra', nargs='*', help="extra arguments passed to every run (after --)")
+    args = parser.parse_args()
+
+    params = {}
+    for item in args.param:
+        name, _, spec = item.partition('=')
+        params[name] = parse_values(spec)
+
+    binary = args.binary or find_binary(args.program, args.ns3_dir)
+    duration = DEFAULT_DURATION
+    if args.scenario:
+        duration = float(read_scenario(args.scenario).get('duration', duration))
+        args.extra = [f"--scenario={os.path.abspath(args.scenario)}"] + args.extra
+    points = build_points(params)
+    predictions = [None] * len(points)
+    confident = [False] * len(points)
+    if args.prescreen is not None:
+        # what every run gets besides its point: the scenario file, then the extra --name=value arguments
+        base = read_scenario(args.scenario) if args.scenario else {}
+        base.update(a[2:].split('=', 1) for a in args.extra if a.startswith('--') and '=' in a)
+        predictions = [predict(dict(base, **point)) for point in points]
+        confident = [p is not None and p['margin'] >= args.prescreen for p in predictions]
+        print(f"{sum(confident)} of {len(points)} points predicted at least {args.prescreen} dB from a threshold, "
+              f"{args.prescreen_runs} runs each")
+    runs = [args.prescreen_runs if sure else args.runs for sure in confident]
+    jobs = build_jobs(points, runs, args.rng_run_base, duration)
+    print(f"{len(points)} points, {len(jobs)} runs of {binary} on {args.jobs} workers")
+
+    cache = None if args.no_cache else ResultsCache(os.path.join(args.ns3_dir, args.cache),
+                                                    os.path.join(args.ns3_dir, 'build', 'lib'))
+    start = time.time()
+    run_jobs(binary, jobs, args.jobs, args.extra, args.ns3_dir, cache=cache)
+    if args.ci_target:
+        target, relative = parse_ci_target(args.ci_target)
+        # the prediction stands in for the replications of the confident points
+        attempted = [args.max_runs if sure else args.runs for sure in confident]
+        while True:
+            extra = more_runs(summarize(points, jobs), attempted, target, relative, args.max_runs)
+            if not any(extra):
+                break
+            round_jobs = build_jobs(points, extra, args.rng_run_base, duration, first=attempted)
+            print(f"{sum(1 for e in extra if e)} points above the CI target, {len(round_jobs)} more runs")
+            run_jobs(binary, round_jobs, args.jobs, args.extra, args.ns3_dir, cache=cache)
+            jobs += round_jobs
+            attempted = [a + e for a, e in zip(attempted, extra)]
+    print(f"Sweep finished in {time.time() - start:.1f} s" +
+          (f", {cache.hits} of {cache.hits + cache.misses} runs from the cache" if cache else ""))
+
+    names = sorted({k for p in points for k in p})
+    with open(args.output, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(names + ['rngRun', 'throughputAX', 'throughputLegacy', 'totalThroughput',
+                                 'bssThroughput', 'staThroughput', 'wallTime', 'events', 'peakRss', 'error'])
+        for job in sorted(jobs, key=lambda j: (j['point'], j['rngRun'])):
+            r = job['result']
+            writer.writerow([job['params'].get(n, '') for n in names] +
+                            [job['rngRun'], r.get('throughputAX', ''), r.get('throughputLegacy', ''),
+                             r.get('totalThroughput', ''),
+                             ' '.join(str(b['throughput']) for b in r.get('bss', [])),
+                             ' '.join(str(f['throughput']) for f in r.get('flows', [])),
+                             f"{r['wallTime']:.3f}", r.get('events', ''), r.get('peakRss', ''), r.get('error', '')])
+
+    with open(args.summary, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=names + ['runs', 'mean', 'ci95', 'predicted', 'margin'])
+        writer.writeheader()
+        for row, prediction in zip(summarize(points, jobs), predictions):
+            if prediction is not None:
+                row.update(predicted=prediction['total'], margin=prediction['margin'])
+            writer.writerow(row)
+
+
+if __name__ == '__main__':
+    main()